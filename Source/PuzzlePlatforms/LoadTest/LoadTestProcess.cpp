@@ -0,0 +1,62 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "LoadTestProcess.h"
+#include "HAL/PlatformTime.h"
+#include "Misc/Paths.h"
+
+namespace
+{
+    FProcHandle LaunchProject(const FString &Params)
+    {
+        const FString Executable = FPlatformProcess::ExecutablePath();
+        const FString Project = FPaths::ConvertRelativePathToFull(FPaths::GetProjectFilePath());
+        const FString ProjectParams = FString::Printf(TEXT("\"%s\" %s"), *Project, *Params);
+
+        return FPlatformProcess::CreateProc(*Executable, *ProjectParams, true, true, true, nullptr, 0, nullptr, nullptr);
+    }
+
+    void Close(FProcHandle &Process)
+    {
+        if (FPlatformProcess::IsProcRunning(Process))
+        {
+            FPlatformProcess::TerminateProc(Process, true);
+        }
+        FPlatformProcess::CloseProc(Process);
+    }
+}
+
+FProcHandle LoadTestProcess::LaunchServer(const FString &Map, const FString &Params)
+{
+    return LaunchProject(FString::Printf(TEXT("%s -server -nosteam -unattended %s"), *Map, *Params));
+}
+
+void LoadTestProcess::LaunchBots(int32 NumBots, const FString &LogName, TArray<FProcHandle> &OutBots)
+{
+    // Bots connect straight to the loopback address, there is nothing to gain from a session search here
+    for (int32 i = 0; i < NumBots; ++i)
+    {
+        FProcHandle Bot = LaunchProject(FString::Printf(
+            TEXT("127.0.0.1 -game -nullrhi -nosound -nosteam -unattended -log=%s%d.log -LoadTestBot"), *LogName, i));
+
+        if (Bot.IsValid())
+        {
+            OutBots.Add(Bot);
+        }
+    }
+}
+
+void LoadTestProcess::WaitForServer(FProcHandle &Server, TArray<FProcHandle> &Bots, double Timeout)
+{
+    const double Deadline = FPlatformTime::Seconds() + Timeout;
+    while (FPlatformProcess::IsProcRunning(Server) && FPlatformTime::Seconds() < Deadline)
+    {
+        FPlatformProcess::Sleep(1.f);
+    }
+
+    Close(Server);
+    for (FProcHandle &Bot : Bots)
+    {
+        Close(Bot);
+    }
+    Bots.Empty();
+}
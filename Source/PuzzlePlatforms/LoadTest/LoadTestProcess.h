@@ -0,0 +1,19 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/PlatformProcess.h"
+
+/** Starts and reaps the headless server and bot processes of load test and benchmark runs */
+namespace LoadTestProcess
+{
+    // Starts a dedicated server of this project on Map, Params are appended to the common flags
+    PUZZLEPLATFORMS_API FProcHandle LaunchServer(const FString &Map, const FString &Params);
+
+    // Starts bots connecting to the loopback server, each logging to <LogName><Index>.log
+    PUZZLEPLATFORMS_API void LaunchBots(int32 NumBots, const FString &LogName, TArray<FProcHandle> &OutBots);
+
+    // Waits for the server to exit on its own for up to Timeout seconds, then stops and closes every process
+    PUZZLEPLATFORMS_API void WaitForServer(FProcHandle &Server, TArray<FProcHandle> &Bots, double Timeout);
+}
@@ -0,0 +1,234 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "LoadTestSubsystem.h"
+#include "PuzzlePlatforms.h"
+#include "Engine/NetConnection.h"
+#include "Engine/NetDriver.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "GameFramework/Pawn.h"
+#include "GameFramework/PlayerController.h"
+#include "HAL/PlatformTime.h"
+#include "Misc/CommandLine.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Parse.h"
+#include "Misc/Paths.h"
+
+#include "PlatformTrigger.h"
+
+bool ULoadTestSubsystem::ShouldCreateSubsystem(UObject *Outer) const
+{
+    return FParse::Param(FCommandLine::Get(), TEXT("LoadTest")) || FParse::Param(FCommandLine::Get(), TEXT("LoadTestBot"));
+}
+
+void ULoadTestSubsystem::Initialize(FSubsystemCollectionBase &Collection)
+{
+    Super::Initialize(Collection);
+
+    IsServer = FParse::Param(FCommandLine::Get(), TEXT("LoadTest"));
+    IsBot = !IsServer;
+
+    FParse::Value(FCommandLine::Get(), TEXT("LoadTestDuration="), Duration);
+    ReportPath = FPaths::ProjectSavedDir() / TEXT("LoadTest") / TEXT("Report.json");
+    FParse::Value(FCommandLine::Get(), TEXT("LoadTestReport="), ReportPath);
+
+    StartTime = FPlatformTime::Seconds();
+    LastSampleTime = StartTime;
+    TravelStartTime = StartTime;
+
+    PreLoadMapHandle = FCoreUObjectDelegates::PreLoadMap.AddUObject(this, &ULoadTestSubsystem::OnPreLoadMap);
+    SeamlessTravelStartHandle = FWorldDelegates::OnSeamlessTravelStart.AddUObject(this, &ULoadTestSubsystem::OnSeamlessTravelStart);
+    PostLoadMapHandle = FCoreUObjectDelegates::PostLoadMapWithWorld.AddUObject(this, &ULoadTestSubsystem::OnPostLoadMapWithWorld);
+}
+
+void ULoadTestSubsystem::Deinitialize()
+{
+    FCoreUObjectDelegates::PreLoadMap.Remove(PreLoadMapHandle);
+    FWorldDelegates::OnSeamlessTravelStart.Remove(SeamlessTravelStartHandle);
+    FCoreUObjectDelegates::PostLoadMapWithWorld.Remove(PostLoadMapHandle);
+
+    Super::Deinitialize();
+}
+
+void ULoadTestSubsystem::Tick(float DeltaTime)
+{
+    if (IsServer)
+    {
+        TickServer(DeltaTime);
+    }
+    else if (IsBot)
+    {
+        TickBot(DeltaTime);
+    }
+}
+
+bool ULoadTestSubsystem::IsTickable() const
+{
+    return !IsTemplate() && (IsServer || IsBot);
+}
+
+TStatId ULoadTestSubsystem::GetStatId() const
+{
+    RETURN_QUICK_DECLARE_CYCLE_STAT(ULoadTestSubsystem, STATGROUP_Tickables);
+}
+
+UWorld *ULoadTestSubsystem::GetTickableGameObjectWorld() const
+{
+    return GetGameInstance() != nullptr ? GetGameInstance()->GetWorld() : nullptr;
+}
+
+void ULoadTestSubsystem::OnPreLoadMap(const FString &MapName)
+{
+    // A seamless travel already started timing when ServerTravel was called
+    UWorld *World = GetTickableGameObjectWorld();
+    if (World != nullptr && World->IsInSeamlessTravel()) return;
+
+    TravelStartTime = FPlatformTime::Seconds();
+}
+
+void ULoadTestSubsystem::OnSeamlessTravelStart(UWorld *World, const FString &LevelName)
+{
+    TravelStartTime = FPlatformTime::Seconds();
+}
+
+void ULoadTestSubsystem::OnPostLoadMapWithWorld(UWorld *World)
+{
+    if (World == nullptr) return;
+
+    // The transition map of a seamless travel is timed from the same start as its destination
+    MapLoadTimes.Emplace(World->GetMapName(), FPlatformTime::Seconds() - TravelStartTime);
+}
+
+void ULoadTestSubsystem::TickServer(float DeltaTime)
+{
+    if (ReportWritten) return;
+
+    FrameTimesMs.Add(FPlatformTime::ToMilliseconds(GGameThreadTime));
+
+    const double Now = FPlatformTime::Seconds();
+
+    UWorld *World = GetTickableGameObjectWorld();
+    UNetDriver *NetDriver = World != nullptr ? World->GetNetDriver() : nullptr;
+
+    // Connections update their byte rates once per stat period, sampling faster adds nothing
+    if (NetDriver != nullptr && Now - LastSampleTime >= 1.0)
+    {
+        LastSampleTime = Now;
+
+        for (UNetConnection *Connection : NetDriver->ClientConnections)
+        {
+            if (Connection == nullptr) continue;
+
+            FConnectionSample &Sample = ConnectionSamples.FindOrAdd(Connection->LowLevelGetRemoteAddress(true));
+            Sample.OutBytesPerSecond += Connection->OutBytesPerSecond;
+            Sample.InBytesPerSecond += Connection->InBytesPerSecond;
+            ++Sample.NumSamples;
+        }
+    }
+
+    if (Now - StartTime >= Duration)
+    {
+        WriteReport();
+        ReportWritten = true;
+        FPlatformMisc::RequestExit(false);
+    }
+}
+
+void ULoadTestSubsystem::TickBot(float DeltaTime)
+{
+    UWorld *World = GetTickableGameObjectWorld();
+    if (World == nullptr || World->GetNetMode() != NM_Client) return;
+
+    APlayerController *PlayerController = GetGameInstance()->GetFirstLocalPlayerController(World);
+    APawn *Pawn = PlayerController != nullptr ? PlayerController->GetPawn() : nullptr;
+    if (Pawn == nullptr) return;
+
+    if (TriggersWorld.Get() != World)
+    {
+        TriggersWorld = World;
+        TargetTrigger.Reset();
+        Dwelling = false;
+
+        Triggers.Reset();
+        for (TActorIterator<APlatformTrigger> It(World); It; ++It)
+        {
+            Triggers.Add(*It);
+        }
+    }
+
+    StateTimeLeft -= DeltaTime;
+
+    if (!TargetTrigger.IsValid() && Triggers.Num() > 0)
+    {
+        TargetTrigger = Triggers[FMath::RandRange(0, Triggers.Num() - 1)];
+        Dwelling = false;
+    }
+
+    if (TargetTrigger.IsValid())
+    {
+        const FVector ToTarget = TargetTrigger->GetActorLocation() - Pawn->GetActorLocation();
+
+        if (!Dwelling && ToTarget.Size2D() > 50.f)
+        {
+            Pawn->AddMovementInput(ToTarget.GetSafeNormal2D(), 1.f);
+        }
+        else if (!Dwelling)
+        {
+            Dwelling = true;
+            StateTimeLeft = 3.f;
+        }
+        else if (StateTimeLeft <= 0.f)
+        {
+            TargetTrigger.Reset();
+        }
+        return;
+    }
+
+    // Maps without triggers, like the lobby, just get some movement traffic
+    if (StateTimeLeft <= 0.f)
+    {
+        WanderDirection = FVector(FMath::RandPointInCircle(1.f), 0.f).GetSafeNormal();
+        StateTimeLeft = 2.f;
+    }
+    Pawn->AddMovementInput(WanderDirection, 1.f);
+}
+
+void ULoadTestSubsystem::WriteReport() const
+{
+    TArray<float> SortedFrames = FrameTimesMs;
+    SortedFrames.Sort();
+
+    double FrameSum = 0;
+    for (float FrameMs : SortedFrames)
+    {
+        FrameSum += FrameMs;
+    }
+
+    const int32 NumFrames = SortedFrames.Num();
+    const double AverageFrameMs = NumFrames > 0 ? FrameSum / NumFrames : 0;
+    const float P95FrameMs = NumFrames > 0 ? SortedFrames[FMath::Min(NumFrames - 1, (int32)(NumFrames * 0.95f))] : 0;
+    const float MaxFrameMs = NumFrames > 0 ? SortedFrames.Last() : 0;
+
+    FString Connections;
+    for (const TPair<FString, FConnectionSample> &Pair : ConnectionSamples)
+    {
+        const FConnectionSample &Sample = Pair.Value;
+        const int32 NumSamples = FMath::Max(Sample.NumSamples, 1);
+
+        Connections += FString::Printf(TEXT("%s{\"address\":\"%s\",\"out_bytes_per_second\":%.1f,\"in_bytes_per_second\":%.1f}"),
+            Connections.IsEmpty() ? TEXT("") : TEXT(","), *Pair.Key, Sample.OutBytesPerSecond / NumSamples, Sample.InBytesPerSecond / NumSamples);
+    }
+
+    FString MapLoads;
+    for (const TPair<FString, double> &MapLoad : MapLoadTimes)
+    {
+        MapLoads += FString::Printf(TEXT("%s{\"map\":\"%s\",\"travel_seconds\":%.3f}"), MapLoads.IsEmpty() ? TEXT("") : TEXT(","), *MapLoad.Key, MapLoad.Value);
+    }
+
+    const FString Report = FString::Printf(
+        TEXT("{\"duration_seconds\":%.1f,\"frames\":%d,\"frame_ms\":{\"average\":%.3f,\"p95\":%.3f,\"max\":%.3f},\"connections\":[%s],\"map_loads\":[%s]}\n"),
+        FPlatformTime::Seconds() - StartTime, NumFrames, AverageFrameMs, P95FrameMs, MaxFrameMs, *Connections, *MapLoads);
+
+    FFileHelper::SaveStringToFile(Report, *ReportPath);
+    UE_LOG(LogPuzzlePlatforms, Display, TEXT("Load test report written to %s"), *ReportPath);
+}
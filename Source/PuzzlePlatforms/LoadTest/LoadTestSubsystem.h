@@ -0,0 +1,74 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/GameInstanceSubsystem.h"
+#include "Tickable.h"
+#include "LoadTestSubsystem.generated.h"
+
+/**
+ * Only exists in processes started by the load test commandlet.
+ * With -LoadTest it samples server frame time, per connection bandwidth and how long
+ * each travel took to load its map, then writes a JSON report and exits after
+ * -LoadTestDuration seconds.
+ * With -LoadTestBot it steers the local pawn from one platform trigger to the next.
+ */
+UCLASS()
+class PUZZLEPLATFORMS_API ULoadTestSubsystem : public UGameInstanceSubsystem, public FTickableGameObject
+{
+    GENERATED_BODY()
+
+public:
+    virtual bool ShouldCreateSubsystem(UObject *Outer) const override;
+    virtual void Initialize(FSubsystemCollectionBase &Collection) override;
+    virtual void Deinitialize() override;
+
+    virtual void Tick(float DeltaTime) override;
+    virtual bool IsTickable() const override;
+    virtual TStatId GetStatId() const override;
+    virtual UWorld *GetTickableGameObjectWorld() const override;
+
+private:
+    struct FConnectionSample
+    {
+        double OutBytesPerSecond = 0;
+        double InBytesPerSecond = 0;
+        int32 NumSamples = 0;
+    };
+
+    bool IsServer = false;
+    bool IsBot = false;
+
+    // Server
+    float Duration = 60.f;
+    FString ReportPath;
+    double StartTime = 0;
+    double LastSampleTime = 0;
+    TArray<float> FrameTimesMs;
+    TMap<FString, FConnectionSample> ConnectionSamples;
+    TArray<TPair<FString, double>> MapLoadTimes;
+
+    // When the current travel started, the process start for the first map
+    double TravelStartTime = 0;
+    bool ReportWritten = false;
+
+    // Bot
+    TArray<TWeakObjectPtr<AActor>> Triggers;
+    TWeakObjectPtr<UWorld> TriggersWorld;
+    TWeakObjectPtr<AActor> TargetTrigger;
+    FVector WanderDirection = FVector::ForwardVector;
+    float StateTimeLeft = 0.f;
+    bool Dwelling = false;
+
+    FDelegateHandle PreLoadMapHandle;
+    FDelegateHandle SeamlessTravelStartHandle;
+    FDelegateHandle PostLoadMapHandle;
+
+    void OnPreLoadMap(const FString &MapName);
+    void OnSeamlessTravelStart(UWorld *World, const FString &LevelName);
+    void OnPostLoadMapWithWorld(UWorld *World);
+    void TickServer(float DeltaTime);
+    void TickBot(float DeltaTime);
+    void WriteReport() const;
+};
@@ -0,0 +1,299 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "PlatformBenchmarkSubsystem.h"
+#include "PuzzlePlatforms.h"
+#include "Engine/NetDriver.h"
+#include "Engine/StaticMesh.h"
+#include "Engine/World.h"
+#include "Components/StaticMeshComponent.h"
+#include "HAL/PlatformMemory.h"
+#include "HAL/PlatformTime.h"
+#include "Misc/CommandLine.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Parse.h"
+#include "Misc/Paths.h"
+#include "UObject/UObjectArray.h"
+
+#include "MovingPlatform.h"
+#include "MovingPlatformSubsystem.h"
+#include "PlatformField.h"
+#include "PlatformTrigger.h"
+
+namespace
+{
+    const float PlatformSpacing = 400.f;
+    const float PlatformHeight = 1500.f;
+    const float PlatformTravel = 300.f;
+    const float TriggerSpacing = 400.f;
+
+    // Clients that never show up should not hang the benchmark
+    const double ClientWaitTimeout = 60.0;
+}
+
+bool UPlatformBenchmarkSubsystem::ShouldCreateSubsystem(UObject *Outer) const
+{
+    return FParse::Param(FCommandLine::Get(), TEXT("PlatformBenchmark"));
+}
+
+void UPlatformBenchmarkSubsystem::Initialize(FSubsystemCollectionBase &Collection)
+{
+    Super::Initialize(Collection);
+
+    FParse::Value(FCommandLine::Get(), TEXT("BenchmarkPlatforms="), NumPlatforms);
+    FParse::Value(FCommandLine::Get(), TEXT("BenchmarkTriggers="), NumTriggers);
+    FParse::Value(FCommandLine::Get(), TEXT("BenchmarkClients="), NumClients);
+    FParse::Value(FCommandLine::Get(), TEXT("BenchmarkFrames="), NumFrames);
+    FParse::Value(FCommandLine::Get(), TEXT("BenchmarkWarmup="), NumWarmupFrames);
+    Deterministic = FParse::Param(FCommandLine::Get(), TEXT("BenchmarkDeterministic"));
+    Field = FParse::Param(FCommandLine::Get(), TEXT("BenchmarkField"));
+
+    ReportPath = FPaths::ProjectSavedDir() / TEXT("Benchmark") / FString::Printf(TEXT("Platforms%d.json"), NumPlatforms);
+    FParse::Value(FCommandLine::Get(), TEXT("BenchmarkReport="), ReportPath);
+
+    WaitStartTime = FPlatformTime::Seconds();
+    Samples.Reserve(NumFrames);
+
+    TickStartHandle = FWorldDelegates::OnWorldTickStart.AddUObject(this, &UPlatformBenchmarkSubsystem::OnWorldTickStart);
+    PostActorTickHandle = FWorldDelegates::OnWorldPostActorTick.AddUObject(this, &UPlatformBenchmarkSubsystem::OnWorldPostActorTick);
+}
+
+void UPlatformBenchmarkSubsystem::Deinitialize()
+{
+    FWorldDelegates::OnWorldTickStart.Remove(TickStartHandle);
+    FWorldDelegates::OnWorldPostActorTick.Remove(PostActorTickHandle);
+
+    Super::Deinitialize();
+}
+
+bool UPlatformBenchmarkSubsystem::IsTickable() const
+{
+    return !IsTemplate() && State != EBenchmarkState::Done;
+}
+
+TStatId UPlatformBenchmarkSubsystem::GetStatId() const
+{
+    RETURN_QUICK_DECLARE_CYCLE_STAT(UPlatformBenchmarkSubsystem, STATGROUP_Tickables);
+}
+
+UWorld *UPlatformBenchmarkSubsystem::GetTickableGameObjectWorld() const
+{
+    return GetGameInstance() != nullptr ? GetGameInstance()->GetWorld() : nullptr;
+}
+
+void UPlatformBenchmarkSubsystem::Tick(float DeltaTime)
+{
+    UWorld *World = GetTickableGameObjectWorld();
+    if (World == nullptr || World->GetNetDriver() == nullptr) return;
+
+    switch (State)
+    {
+    case EBenchmarkState::WaitingForWorld:
+        if (World->GetNetDriver()->ClientConnections.Num() < NumClients && FPlatformTime::Seconds() - WaitStartTime < ClientWaitTimeout) return;
+
+        BaselineUsedPhysical = FPlatformMemory::GetStats().UsedPhysical;
+        BaselineObjects = GUObjectArray.GetObjectArrayNumMinusAvailable();
+
+        if (Field)
+        {
+            SpawnField(World);
+        }
+        else
+        {
+            SpawnPlatforms(World);
+        }
+        State = EBenchmarkState::Warmup;
+        WarmupFramesLeft = NumWarmupFrames;
+        break;
+
+    case EBenchmarkState::Warmup:
+        if (--WarmupFramesLeft > 0) return;
+
+        State = EBenchmarkState::Recording;
+        break;
+
+    case EBenchmarkState::Recording:
+        // Samples are taken at the start of each frame, so count those rather than ticks
+        if (Samples.Num() < NumFrames) return;
+
+        WriteReport(World);
+        State = EBenchmarkState::Done;
+        FPlatformMisc::RequestExit(false);
+        break;
+
+    default:
+        break;
+    }
+}
+
+void UPlatformBenchmarkSubsystem::OnWorldTickStart(UWorld *World, ELevelTick TickType, float DeltaSeconds)
+{
+    if (World != GetTickableGameObjectWorld()) return;
+
+    const double Now = FPlatformTime::Seconds();
+
+    // Everything between the end of actor ticking and the next frame. The net driver flushing replicated
+    // actors to the connections is most of it on a server, but not all of it, so it is not reported as such.
+    // Run with -benchmark so frame rate smoothing does not sleep in there.
+    if (State == EBenchmarkState::Recording && Samples.Num() < NumFrames && LastTickStartTime > 0 && PostActorTickTime > 0)
+    {
+        UNetDriver *NetDriver = World->GetNetDriver();
+        UMovingPlatformSubsystem *PlatformSubsystem = World->GetSubsystem<UMovingPlatformSubsystem>();
+
+        FFrameSample &Sample = Samples.AddDefaulted_GetRef();
+        Sample.FrameMs = (Now - LastTickStartTime) * 1000.0;
+        Sample.PostTickMs = (Now - PostActorTickTime) * 1000.0;
+        Sample.PlatformMs = PlatformSubsystem != nullptr ? PlatformSubsystem->GetLastTickMs() : 0.f;
+        Sample.OutBytes = NetDriver != nullptr ? NetDriver->OutTotalBytes - LastOutTotalBytes : 0;
+    }
+
+    UNetDriver *NetDriver = World->GetNetDriver();
+    LastOutTotalBytes = NetDriver != nullptr ? NetDriver->OutTotalBytes : 0;
+    LastTickStartTime = Now;
+    PostActorTickTime = 0;
+}
+
+void UPlatformBenchmarkSubsystem::OnWorldPostActorTick(UWorld *World, ELevelTick TickType, float DeltaSeconds)
+{
+    if (World != GetTickableGameObjectWorld()) return;
+
+    PostActorTickTime = FPlatformTime::Seconds();
+}
+
+void UPlatformBenchmarkSubsystem::SpawnPlatforms(UWorld *World)
+{
+    UStaticMesh *Cube = LoadObject<UStaticMesh>(nullptr, TEXT("/Engine/BasicShapes/Cube.Cube"));
+
+    TArray<AMovingPlatform *> Platforms;
+    Platforms.Reserve(NumPlatforms);
+
+    const int32 PlatformColumns = FMath::Max(1, FMath::CeilToInt(FMath::Sqrt((float)NumPlatforms)));
+    const FVector PlatformOrigin(-PlatformColumns * PlatformSpacing * 0.5f, -PlatformColumns * PlatformSpacing * 0.5f, PlatformHeight);
+
+    for (int32 i = 0; i < NumPlatforms; ++i)
+    {
+        const FVector Location = PlatformOrigin + FVector((i % PlatformColumns) * PlatformSpacing, (i / PlatformColumns) * PlatformSpacing, 0.f);
+
+        AMovingPlatform *Platform = World->SpawnActorDeferred<AMovingPlatform>(AMovingPlatform::StaticClass(), FTransform(Location));
+        if (Platform == nullptr) continue;
+
+        Platform->TargetLocation = FVector(0.f, 0.f, PlatformTravel);
+        Platform->Speed = FMath::FRandRange(50.f, 150.f);
+        Platform->bDeterministicMotion = Deterministic;
+        Platform->GetStaticMeshComponent()->SetStaticMesh(Cube);
+        Platform->FinishSpawning(FTransform(Location));
+
+        Platforms.Add(Platform);
+    }
+
+    const int32 TriggerColumns = FMath::Max(1, FMath::CeilToInt(FMath::Sqrt((float)NumTriggers)));
+    const FVector TriggerOrigin(-TriggerColumns * TriggerSpacing * 0.5f, -TriggerColumns * TriggerSpacing * 0.5f, 0.f);
+
+    for (int32 i = 0; i < NumTriggers; ++i)
+    {
+        const FVector Location = TriggerOrigin + FVector((i % TriggerColumns) * TriggerSpacing, (i / TriggerColumns) * TriggerSpacing, 0.f);
+
+        APlatformTrigger *Trigger = World->SpawnActor<APlatformTrigger>(APlatformTrigger::StaticClass(), FTransform(Location));
+        if (Trigger == nullptr) continue;
+
+        ++NumSpawnedTriggers;
+        if (Platforms.Num() == 0) continue;
+
+        Trigger->AddPlatformToTrigger(Platforms[i % Platforms.Num()]);
+    }
+
+    UE_LOG(LogPuzzlePlatforms, Display, TEXT("Benchmark spawned %d platforms and %d triggers"), Platforms.Num(), NumSpawnedTriggers);
+}
+
+void UPlatformBenchmarkSubsystem::SpawnField(UWorld *World)
+{
+    const int32 PlatformColumns = FMath::Max(1, FMath::CeilToInt(FMath::Sqrt((float)NumPlatforms)));
+    const FVector PlatformOrigin(-PlatformColumns * PlatformSpacing * 0.5f, -PlatformColumns * PlatformSpacing * 0.5f, PlatformHeight);
+
+    APlatformField *PlatformField = World->SpawnActorDeferred<APlatformField>(APlatformField::StaticClass(), FTransform(PlatformOrigin));
+    if (PlatformField == nullptr) return;
+
+    PlatformField->Instances.Reserve(NumPlatforms);
+    for (int32 i = 0; i < NumPlatforms; ++i)
+    {
+        const FVector Location((i % PlatformColumns) * PlatformSpacing, (i / PlatformColumns) * PlatformSpacing, 0.f);
+
+        FPlatformFieldInstance &Instance = PlatformField->Instances.AddDefaulted_GetRef();
+        Instance.Transform = FTransform(Location);
+        Instance.TargetLocation = Location + FVector(0.f, 0.f, PlatformTravel);
+        Instance.Speed = FMath::FRandRange(50.f, 150.f);
+    }
+    PlatformField->FinishSpawning(FTransform(PlatformOrigin));
+
+    // Fields have nothing for triggers to drive, spawn them anyway so the overlap load matches
+    const int32 TriggerColumns = FMath::Max(1, FMath::CeilToInt(FMath::Sqrt((float)NumTriggers)));
+    const FVector TriggerOrigin(-TriggerColumns * TriggerSpacing * 0.5f, -TriggerColumns * TriggerSpacing * 0.5f, 0.f);
+
+    for (int32 i = 0; i < NumTriggers; ++i)
+    {
+        const FVector Location = TriggerOrigin + FVector((i % TriggerColumns) * TriggerSpacing, (i / TriggerColumns) * TriggerSpacing, 0.f);
+        if (World->SpawnActor<APlatformTrigger>(APlatformTrigger::StaticClass(), FTransform(Location)) != nullptr)
+        {
+            ++NumSpawnedTriggers;
+        }
+    }
+
+    UE_LOG(LogPuzzlePlatforms, Display, TEXT("Benchmark spawned a field of %d platforms and %d triggers"), NumPlatforms, NumSpawnedTriggers);
+}
+
+void UPlatformBenchmarkSubsystem::WriteReport(UWorld *World) const
+{
+    auto Summarize = [this](float FFrameSample::*Field)
+    {
+        TArray<float> Values;
+        Values.Reserve(Samples.Num());
+
+        double Sum = 0;
+        for (const FFrameSample &Sample : Samples)
+        {
+            Values.Add(Sample.*Field);
+            Sum += Sample.*Field;
+        }
+        Values.Sort();
+
+        const int32 Num = Values.Num();
+        return FString::Printf(TEXT("{\"average\":%.4f,\"p95\":%.4f,\"max\":%.4f}"),
+            Num > 0 ? Sum / Num : 0.0,
+            Num > 0 ? Values[FMath::Min(Num - 1, (int32)(Num * 0.95f))] : 0.f,
+            Num > 0 ? Values.Last() : 0.f);
+    };
+
+    uint64 TotalOutBytes = 0;
+    FString Frames;
+    for (const FFrameSample &Sample : Samples)
+    {
+        TotalOutBytes += Sample.OutBytes;
+        Frames += FString::Printf(TEXT("%s[%.4f,%.4f,%.4f,%u]"), Frames.IsEmpty() ? TEXT("") : TEXT(","),
+            Sample.FrameMs, Sample.PlatformMs, Sample.PostTickMs, Sample.OutBytes);
+    }
+
+    UMovingPlatformSubsystem *PlatformSubsystem = World->GetSubsystem<UMovingPlatformSubsystem>();
+    UNetDriver *NetDriver = World->GetNetDriver();
+
+    const uint64 UsedPhysical = FPlatformMemory::GetStats().UsedPhysical;
+    const int32 NumObjects = GUObjectArray.GetObjectArrayNumMinusAvailable();
+
+    const FString Report = FString::Printf(
+        TEXT("{\"platforms\":%d,\"active_platforms\":%d,\"triggers\":%d,\"clients\":%d,\"deterministic\":%s,\"field\":%s,\"frames\":%d,")
+        TEXT("\"frame_ms\":%s,\"platform_update_ms\":%s,\"post_tick_ms\":%s,\"out_bytes_per_frame\":%.1f,")
+        TEXT("\"memory\":{\"used_physical\":%llu,\"used_physical_delta\":%lld,\"objects_delta\":%d},")
+        TEXT("\"samples\":{\"columns\":[\"frame_ms\",\"platform_update_ms\",\"post_tick_ms\",\"out_bytes\"],\"values\":[%s]}}\n"),
+        Field ? NumPlatforms : (PlatformSubsystem != nullptr ? PlatformSubsystem->GetNumPlatforms() : 0),
+        Field ? NumPlatforms : (PlatformSubsystem != nullptr ? PlatformSubsystem->GetNumActivePlatforms() : 0),
+        NumSpawnedTriggers,
+        NetDriver != nullptr ? NetDriver->ClientConnections.Num() : 0,
+        Deterministic ? TEXT("true") : TEXT("false"),
+        Field ? TEXT("true") : TEXT("false"),
+        Samples.Num(),
+        *Summarize(&FFrameSample::FrameMs), *Summarize(&FFrameSample::PlatformMs), *Summarize(&FFrameSample::PostTickMs),
+        Samples.Num() > 0 ? (double)TotalOutBytes / Samples.Num() : 0.0,
+        UsedPhysical, (int64)UsedPhysical - (int64)BaselineUsedPhysical, NumObjects - BaselineObjects,
+        *Frames);
+
+    FFileHelper::SaveStringToFile(Report, *ReportPath);
+    UE_LOG(LogPuzzlePlatforms, Display, TEXT("Benchmark report written to %s"), *ReportPath);
+}
@@ -0,0 +1,79 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/GameInstanceSubsystem.h"
+#include "Tickable.h"
+#include "PlatformBenchmarkSubsystem.generated.h"
+
+/**
+ * Only exists in server processes started by the benchmark commandlet with -PlatformBenchmark.
+ * Spawns a grid of -BenchmarkPlatforms moving platforms and -BenchmarkTriggers triggers into
+ * the loaded map, records -BenchmarkFrames frames and writes per frame platform update,
+ * post tick, bandwidth and memory figures to -BenchmarkReport before exiting. With -BenchmarkField
+ * the platforms are instances of a single APlatformField instead of separate actors.
+ */
+UCLASS()
+class PUZZLEPLATFORMS_API UPlatformBenchmarkSubsystem : public UGameInstanceSubsystem, public FTickableGameObject
+{
+    GENERATED_BODY()
+
+public:
+    virtual bool ShouldCreateSubsystem(UObject *Outer) const override;
+    virtual void Initialize(FSubsystemCollectionBase &Collection) override;
+    virtual void Deinitialize() override;
+
+    virtual void Tick(float DeltaTime) override;
+    virtual bool IsTickable() const override;
+    virtual TStatId GetStatId() const override;
+    virtual UWorld *GetTickableGameObjectWorld() const override;
+
+private:
+    enum class EBenchmarkState
+    {
+        WaitingForWorld,
+        Warmup,
+        Recording,
+        Done
+    };
+
+    struct FFrameSample
+    {
+        float FrameMs = 0.f;
+        float PlatformMs = 0.f;
+        float PostTickMs = 0.f;
+        uint32 OutBytes = 0;
+    };
+
+    int32 NumPlatforms = 100;
+    int32 NumTriggers = 10;
+    int32 NumClients = 0;
+    int32 NumFrames = 300;
+    int32 NumWarmupFrames = 60;
+    bool Deterministic = false;
+    bool Field = false;
+    FString ReportPath;
+
+    EBenchmarkState State = EBenchmarkState::WaitingForWorld;
+    int32 WarmupFramesLeft = 0;
+    int32 NumSpawnedTriggers = 0;
+    double WaitStartTime = 0;
+    TArray<FFrameSample> Samples;
+
+    uint64 BaselineUsedPhysical = 0;
+    int32 BaselineObjects = 0;
+
+    double LastTickStartTime = 0;
+    double PostActorTickTime = 0;
+    uint32 LastOutTotalBytes = 0;
+
+    FDelegateHandle TickStartHandle;
+    FDelegateHandle PostActorTickHandle;
+
+    void OnWorldTickStart(UWorld *World, ELevelTick TickType, float DeltaSeconds);
+    void OnWorldPostActorTick(UWorld *World, ELevelTick TickType, float DeltaSeconds);
+    void SpawnPlatforms(UWorld *World);
+    void SpawnField(UWorld *World);
+    void WriteReport(UWorld *World) const;
+};
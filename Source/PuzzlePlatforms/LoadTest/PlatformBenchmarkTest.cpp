@@ -0,0 +1,74 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "CoreMinimal.h"
+#include "Dom/JsonObject.h"
+#include "HAL/FileManager.h"
+#include "Misc/AutomationTest.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/JsonReader.h"
+#include "Serialization/JsonSerializer.h"
+
+#include "LoadTestProcess.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace
+{
+    const TCHAR *BenchmarkTestMap = TEXT("/Game/PuzzlePlatforms/Maps/Game");
+    const int32 BenchmarkTestFrames = 60;
+    const int32 BenchmarkTestWarmupFrames = 10;
+    const double BenchmarkTestTimeout = 300.0;
+}
+
+// Runs UPlatformBenchmarkSubsystem in a headless server for each platform count and checks the numbers in its report
+IMPLEMENT_COMPLEX_AUTOMATION_TEST(FPlatformBenchmarkTest, "PuzzlePlatforms.Benchmark.Platforms", EAutomationTestFlags::EditorContext | EAutomationTestFlags::PerfFilter)
+
+void FPlatformBenchmarkTest::GetTests(TArray<FString> &OutBeautifiedNames, TArray<FString> &OutTestCommands) const
+{
+    for (const TCHAR *Count : { TEXT("10"), TEXT("100"), TEXT("1000"), TEXT("10000") })
+    {
+        OutBeautifiedNames.Add(FString::Printf(TEXT("%s platforms"), Count));
+        OutTestCommands.Add(Count);
+    }
+}
+
+bool FPlatformBenchmarkTest::RunTest(const FString &Parameters)
+{
+    const int32 NumPlatforms = FCString::Atoi(*Parameters);
+    const int32 NumTriggers = FMath::CeilToInt(NumPlatforms * 0.1f);
+
+    const FString ReportPath = FPaths::ConvertRelativePathToFull(FPaths::ProjectSavedDir() / TEXT("Benchmark") / FString::Printf(TEXT("AutomationPlatforms%d.json"), NumPlatforms));
+    IFileManager::Get().Delete(*ReportPath);
+
+    const FString ServerParams = FString::Printf(
+        TEXT("-benchmark -fps=30 -log=BenchmarkTest%d.log -PlatformBenchmark -BenchmarkPlatforms=%d -BenchmarkTriggers=%d -BenchmarkFrames=%d -BenchmarkWarmup=%d -BenchmarkReport=\"%s\""),
+        NumPlatforms, NumPlatforms, NumTriggers, BenchmarkTestFrames, BenchmarkTestWarmupFrames, *ReportPath);
+
+    FProcHandle Server = LoadTestProcess::LaunchServer(BenchmarkTestMap, ServerParams);
+    if (!TestTrue(TEXT("Benchmark server started"), Server.IsValid())) return false;
+
+    TArray<FProcHandle> Bots;
+    LoadTestProcess::WaitForServer(Server, Bots, BenchmarkTestTimeout);
+
+    FString Report;
+    if (!TestTrue(TEXT("Benchmark server wrote a report"), FFileHelper::LoadFileToString(Report, *ReportPath))) return false;
+
+    TSharedPtr<FJsonObject> Json;
+    if (!TestTrue(TEXT("Benchmark report is valid JSON"), FJsonSerializer::Deserialize(TJsonReaderFactory<>::Create(Report), Json) && Json.IsValid())) return false;
+
+    TestEqual(TEXT("Platforms spawned"), Json->GetIntegerField(TEXT("platforms")), NumPlatforms);
+    TestEqual(TEXT("Triggers spawned"), Json->GetIntegerField(TEXT("triggers")), NumTriggers);
+    TestEqual(TEXT("Frames recorded"), Json->GetIntegerField(TEXT("frames")), BenchmarkTestFrames);
+
+    const TSharedPtr<FJsonObject> *PlatformUpdateMs = nullptr;
+    if (TestTrue(TEXT("Report has platform update times"), Json->TryGetObjectField(TEXT("platform_update_ms"), PlatformUpdateMs)))
+    {
+        TestTrue(TEXT("Platform updates were timed"), (*PlatformUpdateMs)->GetNumberField(TEXT("average")) > 0.0);
+    }
+
+    AddInfo(Report.TrimEnd());
+    return true;
+}
+
+#endif
@@ -0,0 +1,91 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "PuzzlePlatformsBenchmarkCommandlet.h"
+#include "PuzzlePlatforms.h"
+#include "HAL/FileManager.h"
+#include "Misc/DateTime.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Parse.h"
+#include "Misc/Paths.h"
+
+#include "LoadTestProcess.h"
+
+UPuzzlePlatformsBenchmarkCommandlet::UPuzzlePlatformsBenchmarkCommandlet()
+{
+    IsClient = false;
+    IsServer = false;
+    IsEditor = false;
+    LogToConsole = true;
+}
+
+int32 UPuzzlePlatformsBenchmarkCommandlet::Main(const FString &Params)
+{
+    FString Counts = TEXT("10,100,1000,10000");
+    float TriggersPerPlatform = 0.1f;
+    int32 NumClients = 0;
+    int32 NumFrames = 300;
+    int32 FramesPerSecond = 30;
+    float Timeout = 300.f;
+    FString Map = TEXT("/Game/PuzzlePlatforms/Maps/Game");
+    FString Label = FDateTime::Now().ToString();
+
+    FParse::Value(*Params, TEXT("Counts="), Counts);
+    FParse::Value(*Params, TEXT("TriggersPerPlatform="), TriggersPerPlatform);
+    FParse::Value(*Params, TEXT("Clients="), NumClients);
+    FParse::Value(*Params, TEXT("Frames="), NumFrames);
+    FParse::Value(*Params, TEXT("FPS="), FramesPerSecond);
+    FParse::Value(*Params, TEXT("Timeout="), Timeout);
+    FParse::Value(*Params, TEXT("Map="), Map);
+    FParse::Value(*Params, TEXT("Label="), Label);
+    const bool Deterministic = FParse::Param(*Params, TEXT("Deterministic"));
+    const bool Field = FParse::Param(*Params, TEXT("Field"));
+
+    TArray<FString> CountList;
+    Counts.ParseIntoArray(CountList, TEXT(","));
+
+    const FString BenchmarkDir = FPaths::ConvertRelativePathToFull(FPaths::ProjectSavedDir() / TEXT("Benchmark"));
+
+    FString Runs;
+    for (const FString &Count : CountList)
+    {
+        const int32 NumPlatforms = FCString::Atoi(*Count);
+        const int32 NumTriggers = FMath::CeilToInt(NumPlatforms * TriggersPerPlatform);
+        const FString RunPath = BenchmarkDir / FString::Printf(TEXT("Platforms%d.json"), NumPlatforms);
+        IFileManager::Get().Delete(*RunPath);
+
+        // -benchmark runs a fixed time step without idling, so every run simulates the same frames
+        const FString ServerParams = FString::Printf(
+            TEXT("-benchmark -fps=%d -log=Benchmark%d.log -PlatformBenchmark -BenchmarkPlatforms=%d -BenchmarkTriggers=%d -BenchmarkClients=%d -BenchmarkFrames=%d -BenchmarkReport=\"%s\"%s%s"),
+            FramesPerSecond, NumPlatforms, NumPlatforms, NumTriggers, NumClients, NumFrames, *RunPath,
+            Deterministic ? TEXT(" -BenchmarkDeterministic") : TEXT(""), Field ? TEXT(" -BenchmarkField") : TEXT(""));
+
+        UE_LOG(LogPuzzlePlatforms, Display, TEXT("Benchmarking %d platforms and %d triggers"), NumPlatforms, NumTriggers);
+        FProcHandle Server = LoadTestProcess::LaunchServer(Map, ServerParams);
+        if (!Server.IsValid())
+        {
+            UE_LOG(LogPuzzlePlatforms, Error, TEXT("Could not start the benchmark server"));
+            return 1;
+        }
+
+        TArray<FProcHandle> Clients;
+        LoadTestProcess::LaunchBots(NumClients, TEXT("BenchmarkBot"), Clients);
+        LoadTestProcess::WaitForServer(Server, Clients, Timeout);
+
+        FString Run;
+        if (!FFileHelper::LoadFileToString(Run, *RunPath))
+        {
+            UE_LOG(LogPuzzlePlatforms, Error, TEXT("Benchmark server did not write a report to %s"), *RunPath);
+            continue;
+        }
+
+        Run.TrimEndInline();
+        Runs += (Runs.IsEmpty() ? TEXT("") : TEXT(",")) + Run;
+    }
+
+    const FString ReportPath = BenchmarkDir / (Label + TEXT(".json"));
+    const FString Report = FString::Printf(TEXT("{\"label\":\"%s\",\"map\":\"%s\",\"fps\":%d,\"runs\":[%s]}\n"), *Label, *Map, FramesPerSecond, *Runs);
+    FFileHelper::SaveStringToFile(Report, *ReportPath);
+
+    UE_LOG(LogPuzzlePlatforms, Display, TEXT("Benchmark report written to %s"), *ReportPath);
+    return Runs.IsEmpty() ? 1 : 0;
+}
@@ -0,0 +1,23 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "PuzzlePlatformsBenchmarkCommandlet.generated.h"
+
+/**
+ * Runs one headless server per platform count with UPlatformBenchmarkSubsystem and merges
+ * their reports into Saved/Benchmark/<Label>.json, so runs of different commits can be diffed.
+ *
+ * UE4Editor-Cmd PuzzlePlatforms.uproject -run=PuzzlePlatformsBenchmark -Counts=10,100,1000,10000 -Label=baseline
+ */
+UCLASS()
+class PUZZLEPLATFORMS_API UPuzzlePlatformsBenchmarkCommandlet : public UCommandlet
+{
+    GENERATED_BODY()
+
+public:
+    UPuzzlePlatformsBenchmarkCommandlet();
+    virtual int32 Main(const FString &Params) override;
+};
@@ -0,0 +1,63 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "PuzzlePlatformsLoadTestCommandlet.h"
+#include "PuzzlePlatforms.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformProcess.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Parse.h"
+#include "Misc/Paths.h"
+
+#include "LoadTestProcess.h"
+
+UPuzzlePlatformsLoadTestCommandlet::UPuzzlePlatformsLoadTestCommandlet()
+{
+    IsClient = false;
+    IsServer = false;
+    IsEditor = false;
+    LogToConsole = true;
+}
+
+int32 UPuzzlePlatformsLoadTestCommandlet::Main(const FString &Params)
+{
+    int32 NumClients = 4;
+    float Duration = 60.f;
+    float ServerStartup = 10.f;
+    FString Map = TEXT("/Game/PuzzlePlatforms/Maps/Lobby");
+
+    FParse::Value(*Params, TEXT("Clients="), NumClients);
+    FParse::Value(*Params, TEXT("Duration="), Duration);
+    FParse::Value(*Params, TEXT("ServerStartup="), ServerStartup);
+    FParse::Value(*Params, TEXT("Map="), Map);
+
+    const FString ReportPath = FPaths::ConvertRelativePathToFull(FPaths::ProjectSavedDir() / TEXT("LoadTest") / TEXT("Report.json"));
+    IFileManager::Get().Delete(*ReportPath);
+
+    const FString ServerParams = FString::Printf(
+        TEXT("-log=LoadTestServer.log -LoadTest -LoadTestDuration=%f -LoadTestReport=\"%s\" -MaxPlayers=%d"),
+        Duration, *ReportPath, NumClients);
+
+    UE_LOG(LogPuzzlePlatforms, Display, TEXT("Starting load test server with %d clients for %.0f seconds"), NumClients, Duration);
+    FProcHandle Server = LoadTestProcess::LaunchServer(Map, ServerParams);
+    if (!Server.IsValid())
+    {
+        UE_LOG(LogPuzzlePlatforms, Error, TEXT("Could not start the load test server"));
+        return 1;
+    }
+
+    FPlatformProcess::Sleep(ServerStartup);
+
+    TArray<FProcHandle> Clients;
+    LoadTestProcess::LaunchBots(NumClients, TEXT("LoadTestBot"), Clients);
+    LoadTestProcess::WaitForServer(Server, Clients, Duration + 60.0);
+
+    FString Report;
+    if (!FFileHelper::LoadFileToString(Report, *ReportPath))
+    {
+        UE_LOG(LogPuzzlePlatforms, Error, TEXT("Load test server did not write a report to %s"), *ReportPath);
+        return 1;
+    }
+
+    UE_LOG(LogPuzzlePlatforms, Display, TEXT("%s"), *Report);
+    return 0;
+}
@@ -0,0 +1,23 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "PuzzlePlatformsLoadTestCommandlet.generated.h"
+
+/**
+ * Starts a headless server and a number of bot clients on loopback with the NULL
+ * online subsystem, waits for the server's ULoadTestSubsystem report and prints it.
+ *
+ * UE4Editor-Cmd PuzzlePlatforms.uproject -run=PuzzlePlatformsLoadTest -Clients=8 -Duration=120
+ */
+UCLASS()
+class PUZZLEPLATFORMS_API UPuzzlePlatformsLoadTestCommandlet : public UCommandlet
+{
+    GENERATED_BODY()
+
+public:
+    UPuzzlePlatformsLoadTestCommandlet();
+    virtual int32 Main(const FString &Params) override;
+};
@@ -2,19 +2,29 @@
 
 
 #include "LobbyGameMode.h"
+#include "PuzzlePlatforms.h"
 #include "TimerManager.h"
 #include "PuzzlePlatformsGameInstance.h"
 
+static const TCHAR *GameMapPackage = TEXT("/Game/PuzzlePlatforms/Maps/Game");
+
 void ALobbyGameMode::PostLogin(APlayerController* NewPlayer) 
 {
     Super::PostLogin(NewPlayer);
 
     ++PlayersCount;
-    UE_LOG(LogTemp, Warning, TEXT("Players Count: %i"), PlayersCount);
+    UE_LOG(LogPuzzlePlatforms, Log, TEXT("Players Count: %i"), PlayersCount);
+
+    auto GameInstance = Cast<UPuzzlePlatformsGameInstance>(GetGameInstance());
+    if (GameInstance != nullptr && NewPlayer != nullptr && !NewPlayer->IsLocalController())
+    {
+        GameInstance->NotifyClientJoined();
+    }
 
     if (PlayersCount > 1)
     {
         GetWorldTimerManager().SetTimer(GameStartTimer, this, &ALobbyGameMode::StartGame, 5);
+        PreloadGameMap();
     }
 }
 
@@ -23,10 +33,22 @@ void ALobbyGameMode::Logout(AController* Exiting)
     Super::Logout(Exiting);
 
     --PlayersCount;
-    UE_LOG(LogTemp, Warning, TEXT("Players Count: %i"), PlayersCount);
+    UE_LOG(LogPuzzlePlatforms, Log, TEXT("Players Count: %i"), PlayersCount);
 }
 
 void ALobbyGameMode::StartGame() 
+{
+    // Commit to travel only once the game map is in memory
+    if (bGameMapPreloadStarted && !bGameMapPreloaded)
+    {
+        bStartGamePending = true;
+        return;
+    }
+
+    TravelToGame();
+}
+
+void ALobbyGameMode::TravelToGame()
 {
     auto GameInstance = Cast<UPuzzlePlatformsGameInstance>(GetGameInstance());
     if (GameInstance == nullptr) return;
@@ -36,6 +58,38 @@ void ALobbyGameMode::StartGame()
     UWorld *World = GetWorld();
     if (!ensure(World != nullptr)) return;
 
+    GameInstance->BeginTravelTrace(GameMapPackage);
+
     bUseSeamlessTravel = true;
-    World->ServerTravel("/Game/PuzzlePlatforms/Maps/Game?listen");
+    World->ServerTravel(FString::Printf(TEXT("%s?listen"), GameMapPackage));
+}
+
+void ALobbyGameMode::PreloadGameMap()
+{
+    if (bGameMapPreloadStarted) return;
+
+    bGameMapPreloadStarted = true;
+    PreloadStartTime = FPlatformTime::Seconds();
+
+    LoadPackageAsync(GameMapPackage, FLoadPackageAsyncDelegate::CreateUObject(this, &ALobbyGameMode::OnGameMapPreloaded));
+}
+
+void ALobbyGameMode::OnGameMapPreloaded(const FName& PackageName, UPackage* Package, EAsyncLoadingResult::Type Result)
+{
+    bGameMapPreloaded = true;
+
+    UE_LOG(LogPuzzlePlatforms, Log, TEXT("Travel phase preload %s: %.1f ms"), *PackageName.ToString(), (FPlatformTime::Seconds() - PreloadStartTime) * 1000.0);
+
+    // On failure ServerTravel still loads the map itself
+    auto GameInstance = Cast<UPuzzlePlatformsGameInstance>(GetGameInstance());
+    if (GameInstance != nullptr && Result == EAsyncLoadingResult::Succeeded)
+    {
+        GameInstance->HoldPreloadedPackage(Package);
+    }
+
+    if (bStartGamePending)
+    {
+        bStartGamePending = false;
+        TravelToGame();
+    }
 }
@@ -3,6 +3,7 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "UObject/UObjectGlobals.h"
 #include "PuzzlePlatformsGameMode.h"
 #include "LobbyGameMode.generated.h"
 
@@ -20,7 +21,15 @@ public:
 
 private:
     void StartGame();
+    void TravelToGame();
+    void PreloadGameMap();
+    void OnGameMapPreloaded(const FName& PackageName, UPackage* Package, EAsyncLoadingResult::Type Result);
 
     uint16 PlayersCount = 0;
     FTimerHandle GameStartTimer;
+
+    bool bGameMapPreloadStarted = false;
+    bool bGameMapPreloaded = false;
+    bool bStartGamePending = false;
+    double PreloadStartTime = 0;
 };
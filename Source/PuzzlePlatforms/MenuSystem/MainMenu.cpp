@@ -1,12 +1,16 @@
 // Fill out your copyright notice in the Description page of Project Settings.
 
 #include "MainMenu.h"
+#include "PuzzlePlatforms.h"
 #include "Components/Button.h"
 #include "Components/WidgetSwitcher.h"
 #include "Components/EditableTextBox.h"
 #include "Components/PanelWidget.h"
-#include "Components/TextBlock.h"
+#include "Components/ScrollBox.h"
+#include "Components/Spacer.h"
+#include "Blueprint/WidgetTree.h"
 #include "UObject/ConstructorHelpers.h"
+#include "Algo/BinarySearch.h"
 
 #include "ServerRow.h"
 
@@ -17,37 +21,126 @@ UMainMenu::UMainMenu(const FObjectInitializer &ObjectInitializer)
     ServerRowClass = ServerRowBPClass.Class;
 }
 
-void UMainMenu::SetServerList(TArray<FServerData> Servers) 
+// Rows kept alive above and below the visible ones, and shown before the list has been laid out
+static const int32 ServerListRowMargin = 2;
+static const int32 ServerListDefaultRows = 20;
+
+void UMainMenu::SetServerList(TArray<FServerData> &&Servers) 
 {
-    ServersData = Servers;
+    SCOPE_CYCLE_COUNTER(STAT_ServerListUpdate);
 
-    UWorld *World = GetWorld();
-    if (!ensure(World != nullptr)) return;
+    ServersData = MoveTemp(Servers);
+
+    ServerIndexById.Reset();
+    for (int32 i = 0; i < ServersData.Num(); ++i)
+    {
+        ServerIndexById.Add(ServersData[i].SessionId, i);
+    }
 
-    ServerList->ClearChildren();
+    if (SelectedIndex.IsSet() && SelectedIndex.GetValue() >= (uint32)ServersData.Num())
+    {
+        SelectedIndex.Reset();
+    }
 
-    uint32 i = 0;
+    RebuildDisplayOrder();
+    UpdateServerListStats();
+}
 
-    for (FServerData &Server : ServersData)
+void UMainMenu::UpdateServerList(const TArray<FServerData> &Changed, const TArray<FString> &Removed) 
+{
+    SCOPE_CYCLE_COUNTER(STAT_ServerListUpdate);
+
+    for (const FString &SessionId : Removed)
     {
-        UServerRow *Row = CreateWidget<UServerRow>(World, ServerRowClass);
-        if (!ensure(Row != nullptr)) return;
+        int32 Index;
+        if (!ServerIndexById.RemoveAndCopyValue(SessionId, Index)) continue;
+
+        RemoveFromDisplayOrder(Index);
+
+        if (SelectedIndex.IsSet() && SelectedIndex.GetValue() == (uint32)Index)
+        {
+            SelectedIndex.Reset();
+        }
 
-        Row->ServerName->SetText(FText::FromString(Server.Name));
-        Row->CurrentPlayers->SetText(FText::AsNumber(Server.CurrentPlayers));
-        Row->MaxPlayers->SetText(FText::AsNumber(Server.MaxPlayers));
-        Row->HostUsername->SetText(FText::FromString(Server.HostUsername));
-        Row->Setup(this, i);
-        ++i;
+        // The last server is swapped into the hole, its sort key and display position stay the same
+        const int32 LastIndex = ServersData.Num() - 1;
+        const int32 LastPosition = FindDisplayPosition(LastIndex);
+        ServersData.RemoveAtSwap(Index, 1, false);
 
-        ServerList->AddChild(Row);
+        if (Index != LastIndex)
+        {
+            ServerIndexById[ServersData[Index].SessionId] = Index;
+            if (SelectedIndex.IsSet() && SelectedIndex.GetValue() == (uint32)LastIndex)
+            {
+                SelectedIndex = Index;
+            }
+
+            if (LastPosition != INDEX_NONE)
+            {
+                DisplayOrder[LastPosition] = Index;
+                RebindPosition(LastPosition);
+            }
+        }
     }
+
+    for (const FServerData &Server : Changed)
+    {
+        int32 *Index = ServerIndexById.Find(Server.SessionId);
+        if (Index != nullptr)
+        {
+            RemoveFromDisplayOrder(*Index);
+            ServersData[*Index] = Server;
+            InsertIntoDisplayOrder(*Index);
+        }
+        else
+        {
+            const int32 NewIndex = ServersData.Add(Server);
+            ServerIndexById.Add(Server.SessionId, NewIndex);
+            InsertIntoDisplayOrder(NewIndex);
+        }
+    }
+
+    UpdateVisibleRows(false);
+    UpdateServerListStats();
+}
+
+void UMainMenu::UpdateServerListStats() const
+{
+    SET_DWORD_STAT(STAT_NumServerListEntries, ServersData.Num());
+    SET_MEMORY_STAT(STAT_ServerListMemory, ServersData.GetAllocatedSize() + DisplayOrder.GetAllocatedSize() + ServerIndexById.GetAllocatedSize());
 }
 
 void UMainMenu::SelectIndex(uint32 Index) 
 {
+    UServerRow *PreviousRow = SelectedIndex.IsSet() ? GetVisibleRow(SelectedIndex.GetValue()) : nullptr;
+    if (PreviousRow != nullptr)
+    {
+        PreviousRow->Selected = false;
+    }
+
     SelectedIndex = Index;
-    UpdateChildren();
+
+    UServerRow *Row = GetVisibleRow(Index);
+    if (Row != nullptr)
+    {
+        Row->Selected = true;
+    }
+}
+
+void UMainMenu::SetServerSortMode(EServerSortMode InSortMode) 
+{
+    if (SortMode == InSortMode) return;
+
+    SortMode = InSortMode;
+    RebuildDisplayOrder();
+}
+
+void UMainMenu::SetServerFilter(int32 InMaxPing, bool InHideFull, const FString &InNameFilter) 
+{
+    MaxPing = InMaxPing;
+    HideFull = InHideFull;
+    NameFilter = InNameFilter;
+    RebuildDisplayOrder();
 }
 
 bool UMainMenu::Initialize()
@@ -76,6 +169,27 @@ bool UMainMenu::Initialize()
     if (!ensure(QuitButton != nullptr)) return false;
     QuitButton->OnClicked.AddDynamic(this, &UMainMenu::QuitGame);
 
+    if (QuickJoinButton != nullptr)
+    {
+        QuickJoinButton->OnClicked.AddDynamic(this, &UMainMenu::QuickJoinServer);
+    }
+
+    if (!ensure(ServerList != nullptr)) return false;
+    TopSpacer = WidgetTree->ConstructWidget<USpacer>(USpacer::StaticClass());
+    BottomSpacer = WidgetTree->ConstructWidget<USpacer>(USpacer::StaticClass());
+
+    // The server list is either the scroll box itself or its content
+    ServerScrollBox = Cast<UScrollBox>(ServerList);
+    if (ServerScrollBox == nullptr)
+    {
+        ServerScrollBox = Cast<UScrollBox>(ServerList->GetParent());
+    }
+
+    if (ServerScrollBox != nullptr)
+    {
+        ServerScrollBox->OnUserScrolled.AddDynamic(this, &UMainMenu::OnServerListScrolled);
+    }
+
     return true;
 }
 
@@ -92,15 +206,29 @@ void UMainMenu::JoinServer()
 {
     if (SelectedIndex.IsSet() && MenuInterface != nullptr)
     {
-        UE_LOG(LogTemp, Warning, TEXT("Selected Index %d"), SelectedIndex.GetValue());
-        MenuInterface->Join(SelectedIndex.GetValue(), ServersData[SelectedIndex.GetValue()].Name);
+        UE_LOG(LogPuzzlePlatforms, Verbose, TEXT("Selected Index %d"), SelectedIndex.GetValue());
+        const FServerData &Server = ServersData[SelectedIndex.GetValue()];
+        MenuInterface->Join(Server.SessionId, Server.Name);
     }
     else
     {
-        UE_LOG(LogTemp, Warning, TEXT("Selected Index not set"));
+        UE_LOG(LogPuzzlePlatforms, Verbose, TEXT("Selected Index not set"));
+    }
+}
+
+void UMainMenu::QuickJoinServer()
+{
+    if (MenuInterface != nullptr)
+    {
+        MenuInterface->QuickJoin();
     }
 }
 
+void UMainMenu::ResetMenu()
+{
+    OpenMainMenu();
+}
+
 void UMainMenu::OpenHostMenu() 
 {
     if (!ensure(MenuSwitcher != nullptr)) return;
@@ -138,14 +266,195 @@ void UMainMenu::QuitGame()
     PlayerController->ConsoleCommand("quit");
 }
 
-void UMainMenu::UpdateChildren() 
+void UMainMenu::OnServerListScrolled(float CurrentOffset) 
+{
+    UpdateVisibleRows(false);
+}
+
+void UMainMenu::UpdateVisibleRows(bool ForceRebind) 
+{
+    const int32 NumServers = DisplayOrder.Num();
+
+    if (RowPool.Num() == 0 && !AddPooledRow()) return;
+
+    // Desired size is only valid after a layout pass, so run one on a row before measuring it
+    if (RowHeight <= 0)
+    {
+        RowPool[0]->ForceLayoutPrepass();
+        RowHeight = RowPool[0]->GetDesiredSize().Y;
+    }
+    const float Height = RowHeight > 0 ? RowHeight : DefaultRowHeight;
+
+    int32 NumRows = FMath::Min(NumServers, ServerListDefaultRows);
+    int32 FirstRow = 0;
+
+    if (ServerScrollBox != nullptr)
+    {
+        const float ViewHeight = ServerScrollBox->GetCachedGeometry().GetLocalSize().Y;
+        if (ViewHeight > 0)
+        {
+            NumRows = FMath::Min(NumServers, FMath::CeilToInt(ViewHeight / Height) + 2 * ServerListRowMargin);
+        }
+        FirstRow = FMath::FloorToInt(ServerScrollBox->GetScrollOffset() / Height) - ServerListRowMargin;
+        FirstRow = FMath::Clamp(FirstRow, 0, NumServers - NumRows);
+    }
+
+    // Grow the pool only when more rows fit on screen than ever before
+    while (RowPool.Num() < NumRows)
+    {
+        if (!AddPooledRow()) return;
+    }
+
+    if (NumRows != NumVisibleRows)
+    {
+        ServerList->ClearChildren();
+        ServerList->AddChild(TopSpacer);
+        for (int32 i = 0; i < NumRows; ++i)
+        {
+            ServerList->AddChild(RowPool[i]);
+        }
+        ServerList->AddChild(BottomSpacer);
+
+        NumVisibleRows = NumRows;
+        ForceRebind = true;
+    }
+
+    if (FirstRow != FirstVisibleRow)
+    {
+        FirstVisibleRow = FirstRow;
+        ForceRebind = true;
+    }
+
+    if (ForceRebind)
+    {
+        DirtyPosition = FirstVisibleRow;
+    }
+
+    // Only rows at or below the first changed display position show different servers
+    for (int32 Position = FMath::Max(DirtyPosition, FirstVisibleRow); Position < FirstVisibleRow + NumVisibleRows; ++Position)
+    {
+        RebindPosition(Position);
+    }
+    DirtyPosition = MAX_int32;
+
+    // Spacers always stand in for every server out of view, so the scroll range matches the full list
+    TopSpacer->SetSize(FVector2D(0, FirstVisibleRow * Height));
+    BottomSpacer->SetSize(FVector2D(0, (NumServers - FirstVisibleRow - NumVisibleRows) * Height));
+}
+
+bool UMainMenu::AddPooledRow() 
+{
+    UWorld *World = GetWorld();
+    if (!ensure(World != nullptr)) return false;
+
+    UServerRow *Row = CreateWidget<UServerRow>(World, ServerRowClass);
+    if (!ensure(Row != nullptr)) return false;
+
+    Row->Setup(this);
+    RowPool.Add(Row);
+    return true;
+}
+
+void UMainMenu::RebindPosition(int32 Position) 
 {
-    for (int32 i = 0; i < ServerList->GetChildrenCount(); ++i)
+    const int32 RowIndex = Position - FirstVisibleRow;
+    if (RowIndex < 0 || RowIndex >= NumVisibleRows || !DisplayOrder.IsValidIndex(Position)) return;
+
+    const int32 Index = DisplayOrder[Position];
+    RowPool[RowIndex]->SetServerData(ServersData[Index], Index);
+    RowPool[RowIndex]->Selected = (SelectedIndex.IsSet() && SelectedIndex.GetValue() == (uint32)Index);
+}
+
+UServerRow *UMainMenu::GetVisibleRow(uint32 Index) const
+{
+    for (int32 i = 0; i < NumVisibleRows; ++i)
     {
-        UServerRow *Row = Cast<UServerRow>(ServerList->GetChildAt(i));
-        if (Row != nullptr)
+        const int32 Position = FirstVisibleRow + i;
+        if (DisplayOrder.IsValidIndex(Position) && DisplayOrder[Position] == (int32)Index)
         {
-            Row->Selected = (SelectedIndex.IsSet() && SelectedIndex.GetValue() == i);
+            return RowPool[i];
         }
     }
-}
\ No newline at end of file
+
+    return nullptr;
+}
+
+bool UMainMenu::PassesFilter(const FServerData &Server) const
+{
+    if (MaxPing > 0 && Server.PingInMs > MaxPing) return false;
+    if (HideFull && Server.CurrentPlayers >= Server.MaxPlayers) return false;
+    if (!NameFilter.IsEmpty() && !Server.Name.Contains(NameFilter)) return false;
+
+    return true;
+}
+
+bool UMainMenu::IsSortedBefore(int32 A, int32 B) const
+{
+    const FServerData &ServerA = ServersData[A];
+    const FServerData &ServerB = ServersData[B];
+
+    switch (SortMode)
+    {
+    case EServerSortMode::Ping:
+        if (ServerA.PingInMs != ServerB.PingInMs) return ServerA.PingInMs < ServerB.PingInMs;
+        break;
+    case EServerSortMode::FreeSlots:
+    {
+        const int32 FreeA = (int32)ServerA.MaxPlayers - ServerA.CurrentPlayers;
+        const int32 FreeB = (int32)ServerB.MaxPlayers - ServerB.CurrentPlayers;
+        if (FreeA != FreeB) return FreeA > FreeB;
+        break;
+    }
+    case EServerSortMode::Name:
+    {
+        const int32 Compare = ServerA.Name.Compare(ServerB.Name, ESearchCase::IgnoreCase);
+        if (Compare != 0) return Compare < 0;
+        break;
+    }
+    }
+
+    // Session IDs are unique, so this is a strict total order and positions can be binary searched
+    return ServerA.SessionId < ServerB.SessionId;
+}
+
+int32 UMainMenu::FindDisplayPosition(int32 Index) const
+{
+    const int32 Position = Algo::LowerBound(DisplayOrder, Index, [this](int32 A, int32 B) { return IsSortedBefore(A, B); });
+    if (DisplayOrder.IsValidIndex(Position) && DisplayOrder[Position] == Index) return Position;
+
+    return INDEX_NONE;
+}
+
+void UMainMenu::InsertIntoDisplayOrder(int32 Index) 
+{
+    if (!PassesFilter(ServersData[Index])) return;
+
+    const int32 Position = Algo::LowerBound(DisplayOrder, Index, [this](int32 A, int32 B) { return IsSortedBefore(A, B); });
+    DisplayOrder.Insert(Index, Position);
+    DirtyPosition = FMath::Min(DirtyPosition, Position);
+}
+
+void UMainMenu::RemoveFromDisplayOrder(int32 Index) 
+{
+    const int32 Position = FindDisplayPosition(Index);
+    if (Position == INDEX_NONE) return;
+
+    DisplayOrder.RemoveAt(Position, 1, false);
+    DirtyPosition = FMath::Min(DirtyPosition, Position);
+}
+
+void UMainMenu::RebuildDisplayOrder() 
+{
+    DisplayOrder.Reset();
+    for (int32 i = 0; i < ServersData.Num(); ++i)
+    {
+        if (PassesFilter(ServersData[i]))
+        {
+            DisplayOrder.Add(i);
+        }
+    }
+
+    DisplayOrder.Sort([this](int32 A, int32 B) { return IsSortedBefore(A, B); });
+
+    UpdateVisibleRows(true);
+}
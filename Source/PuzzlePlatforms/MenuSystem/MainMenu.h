@@ -6,15 +6,12 @@
 #include "MenuWidget.h"
 #include "MainMenu.generated.h"
 
-USTRUCT()
-struct FServerData
+UENUM(BlueprintType)
+enum class EServerSortMode : uint8
 {
-    GENERATED_BODY()
-
-    FString Name;
-    uint16 CurrentPlayers;
-    uint16 MaxPlayers;
-    FString HostUsername;
+    Ping,
+    FreeSlots,
+    Name
 };
 
 /**
@@ -27,8 +24,17 @@ class PUZZLEPLATFORMS_API UMainMenu : public UMenuWidget
 
 public:
     UMainMenu(const FObjectInitializer &ObjectInitializer);
-    void SetServerList(TArray<FServerData> Servers);
+    void SetServerList(TArray<FServerData> &&Servers);
+    void UpdateServerList(const TArray<FServerData> &Changed, const TArray<FString> &Removed);
     void SelectIndex(uint32 Index);
+    virtual void ResetMenu() override;
+
+    UFUNCTION(BlueprintCallable)
+    void SetServerSortMode(EServerSortMode InSortMode);
+
+    // A MaxPing of 0 accepts any ping
+    UFUNCTION(BlueprintCallable)
+    void SetServerFilter(int32 InMaxPing, bool InHideFull, const FString &InNameFilter);
 
 protected:
     virtual bool Initialize();
@@ -37,6 +43,37 @@ private:
     TSubclassOf<class UUserWidget> ServerRowClass;
     TOptional<uint32> SelectedIndex;
     TArray<FServerData> ServersData;
+    TMap<FString, int32> ServerIndexById;
+
+    // Indices into ServersData that pass the filter, kept sorted as servers change
+    TArray<int32> DisplayOrder;
+    int32 DirtyPosition = MAX_int32;
+
+    EServerSortMode SortMode = EServerSortMode::Ping;
+    int32 MaxPing = 0;
+    bool HideFull = false;
+    FString NameFilter;
+
+    // Only the rows in view exist, they are rebound to new data as the list scrolls
+    UPROPERTY()
+    TArray<class UServerRow *> RowPool;
+
+    UPROPERTY()
+    class USpacer *TopSpacer;
+
+    UPROPERTY()
+    class USpacer *BottomSpacer;
+
+    UPROPERTY()
+    class UScrollBox *ServerScrollBox;
+
+    int32 NumVisibleRows = 0;
+    int32 FirstVisibleRow = 0;
+    float RowHeight = 0;
+
+    // Used for the spacers until a row has been measured
+    UPROPERTY(EditDefaultsOnly, Category = "Server List")
+    float DefaultRowHeight = 40.f;
 
     UPROPERTY(meta = (BindWidget))
     class UButton *HostMenuButton;
@@ -59,6 +96,9 @@ private:
     UPROPERTY(meta = (BindWidget))
     class UButton *QuitButton;
 
+    UPROPERTY(meta = (BindWidgetOptional))
+    class UButton *QuickJoinButton;
+
     UPROPERTY(meta = (BindWidget))
     class UWidgetSwitcher *MenuSwitcher;
 
@@ -83,6 +123,9 @@ private:
     UFUNCTION()
     void JoinServer();
 
+    UFUNCTION()
+    void QuickJoinServer();
+
     UFUNCTION()
     void OpenHostMenu();
 
@@ -95,5 +138,19 @@ private:
     UFUNCTION()
     void QuitGame();
 
-    void UpdateChildren();
+    UFUNCTION()
+    void OnServerListScrolled(float CurrentOffset);
+
+    void UpdateVisibleRows(bool ForceRebind);
+    bool AddPooledRow();
+    void RebindPosition(int32 Position);
+    class UServerRow *GetVisibleRow(uint32 Index) const;
+
+    bool PassesFilter(const FServerData &Server) const;
+    bool IsSortedBefore(int32 A, int32 B) const;
+    int32 FindDisplayPosition(int32 Index) const;
+    void InsertIntoDisplayOrder(int32 Index);
+    void RemoveFromDisplayOrder(int32 Index);
+    void RebuildDisplayOrder();
+    void UpdateServerListStats() const;
 };
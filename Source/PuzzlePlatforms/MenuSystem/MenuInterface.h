@@ -6,6 +6,30 @@
 #include "UObject/Interface.h"
 #include "MenuInterface.generated.h"
 
+USTRUCT()
+struct FServerData
+{
+    GENERATED_BODY()
+
+    FString SessionId;
+    FString Name;
+    uint16 CurrentPlayers = 0;
+    uint16 MaxPlayers = 0;
+    FString HostUsername;
+    int32 PingInMs = 0;
+
+    // Ping jitters on every search, rows only count as changed when it moves to another bucket
+    static constexpr int32 PingBucketMs = 25;
+
+    bool operator==(const FServerData &Other) const
+    {
+        return SessionId == Other.SessionId && Name == Other.Name && CurrentPlayers == Other.CurrentPlayers && MaxPlayers == Other.MaxPlayers && HostUsername == Other.HostUsername
+            && PingInMs / PingBucketMs == Other.PingInMs / PingBucketMs;
+    }
+
+    bool operator!=(const FServerData &Other) const { return !(*this == Other); }
+};
+
 // This class does not need to be modified.
 UINTERFACE(MinimalAPI)
 class UMenuInterface : public UInterface
@@ -23,7 +47,8 @@ class PUZZLEPLATFORMS_API IMenuInterface
 	// Add interface functions to this class. This is the class that will be inherited to implement this interface.
 public:
     virtual void Host(FString ServerName) = 0;
-    virtual void Join(uint32 Index, FString ServerName) = 0;
+    virtual void Join(FString SessionId, FString ServerName) = 0;
+    virtual void QuickJoin() = 0;
     virtual void End() = 0;
     virtual void Destroy() = 0;
     virtual void LoadMainMenu() = 0;
@@ -10,7 +10,10 @@ void UMenuWidget::SetMenuInterface(IMenuInterface* MenuInterfacePtr)
 
 void UMenuWidget::Setup() 
 {
-  this->AddToViewport();
+  if (!IsInViewport())
+  {
+    this->AddToViewport();
+  }
 
   UWorld* World = GetWorld();
   if (!ensure(World != nullptr)) return;
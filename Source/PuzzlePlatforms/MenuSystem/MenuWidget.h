@@ -20,6 +20,9 @@ public:
   void Setup();
   void TearDown();
 
+  // Called when a cached menu is shown again, puts it back into its initial state
+  virtual void ResetMenu() {}
+
 protected:
   IMenuInterface* MenuInterface;
 
@@ -7,11 +7,25 @@
 #include "MainMenu.h"
 
 
-void UServerRow::Setup(class UMainMenu *InParent, uint32 InIndex) 
+void UServerRow::Setup(class UMainMenu *InParent) 
 {
     Parent = InParent;
+    RowButton->OnClicked.AddUniqueDynamic(this, &UServerRow::OnClicked);
+}
+
+void UServerRow::SetServerData(const FServerData &ServerData, uint32 InIndex) 
+{
     Index = InIndex;
-    RowButton->OnClicked.AddDynamic(this, &UServerRow::OnClicked);
+
+    ServerName->SetText(FText::FromString(ServerData.Name));
+    CurrentPlayers->SetText(FText::AsNumber(ServerData.CurrentPlayers));
+    MaxPlayers->SetText(FText::AsNumber(ServerData.MaxPlayers));
+    HostUsername->SetText(FText::FromString(ServerData.HostUsername));
+
+    if (Ping != nullptr)
+    {
+        Ping->SetText(FText::AsNumber(ServerData.PingInMs));
+    }
 }
 
 void UServerRow::OnClicked() 
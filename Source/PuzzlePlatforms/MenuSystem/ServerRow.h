@@ -26,10 +26,14 @@ public:
     UPROPERTY(meta = (BindWidget))
     class UTextBlock *HostUsername;
 
+    UPROPERTY(meta = (BindWidgetOptional))
+    class UTextBlock *Ping;
+
     UPROPERTY(BlueprintReadOnly)
     bool Selected = false;
 
-    void Setup(class UMainMenu *InParent, uint32 InIndex);
+    void Setup(class UMainMenu *InParent);
+    void SetServerData(const struct FServerData &ServerData, uint32 InIndex);
 private:
     uint32 Index;
 
@@ -1,62 +1,127 @@
 // Fill out your copyright notice in the Description page of Project Settings.
 
 #include "MovingPlatform.h"
+#include "MovingPlatformSubsystem.h"
+#include "Net/UnrealNetwork.h"
 
 AMovingPlatform::AMovingPlatform()
 {
-  PrimaryActorTick.bCanEverTick = true;
+  // Movement is driven in batch by UMovingPlatformSubsystem
+  PrimaryActorTick.bCanEverTick = false;
+
+  // Set on the class default so the replication graph has class info for platforms
+  bReplicates = true;
 
   SetMobility(EComponentMobility::Movable);
 }
 
-void AMovingPlatform::Tick(float DeltaTime)
+void AMovingPlatform::AddActiveTrigger()
+{
+  // Deterministic platforms take their trigger count from the server's anchor
+  if (bDeterministicMotion && !HasAuthority()) return;
+
+  ActiveTriggers++;
+  UpdateActiveTriggers();
+}
+
+void AMovingPlatform::RemoveActiveTrigger() 
+{
+  if (bDeterministicMotion && !HasAuthority()) return;
+
+  if (ActiveTriggers > 0) ActiveTriggers--;
+  UpdateActiveTriggers();
+}
+
+void AMovingPlatform::BeginPlay()
 {
-  Super::Tick(DeltaTime);
+  Super::BeginPlay();
 
-  if (ActiveTriggers > 0)
+  if (HasAuthority())
   {
-    if (HasAuthority())
-    {
-      FVector Location = GetActorLocation();
-      float JourneyLength = (GlobalTargetLocation - GlobalStartLocation).Size();
-      float JourneyTravelled = (Location - GlobalStartLocation).Size();
+    SetReplicateMovement(!bDeterministicMotion);
+  }
 
-      if (JourneyTravelled > JourneyLength)
-      {
-        FVector Swap = GlobalStartLocation;
-        GlobalStartLocation = GlobalTargetLocation;
-        GlobalTargetLocation = Swap;
-      }
+  GlobalStartLocation = GetActorLocation();
+  GlobalTargetLocation = GetTransform().TransformPosition(TargetLocation);
+
+  // Clients only simulate deterministic platforms, the rest receive replicated movement
+  if (HasAuthority() || bDeterministicMotion)
+  {
+    UWorld *World = GetWorld();
+    if (!ensure(World != nullptr)) return;
 
-      FVector Direction = (GlobalTargetLocation - GlobalStartLocation).GetSafeNormal();
-      Location += Speed * DeltaTime * Direction;
+    UMovingPlatformSubsystem *PlatformSubsystem = World->GetSubsystem<UMovingPlatformSubsystem>();
+    if (!ensure(PlatformSubsystem != nullptr)) return;
 
-      SetActorLocation(Location);
+    if (HasAuthority())
+    {
+      PlatformSubsystem->RegisterPlatform(this, GlobalStartLocation, GlobalTargetLocation, Speed, ActiveTriggers);
+      MotionAnchor = PlatformSubsystem->GetMotionAnchor(this);
+      UpdateNetDormancy();
+    }
+    else
+    {
+      PlatformSubsystem->RegisterPlatform(this, GlobalStartLocation, GlobalTargetLocation, Speed, 0);
+      PlatformSubsystem->SetMotionAnchor(this, MotionAnchor);
     }
   }
 }
 
-void AMovingPlatform::AddActiveTrigger()
+void AMovingPlatform::EndPlay(const EEndPlayReason::Type EndPlayReason)
 {
-  ActiveTriggers++;
+  UMovingPlatformSubsystem *PlatformSubsystem = GetPlatformSubsystem();
+  if (PlatformSubsystem != nullptr)
+  {
+    PlatformSubsystem->UnregisterPlatform(this);
+  }
+
+  Super::EndPlay(EndPlayReason);
 }
 
-void AMovingPlatform::RemoveActiveTrigger() 
+UMovingPlatformSubsystem *AMovingPlatform::GetPlatformSubsystem() const
 {
-  if (ActiveTriggers > 0) ActiveTriggers--;
+  if (PlatformSlot == INDEX_NONE) return nullptr;
+
+  UWorld *World = GetWorld();
+  if (World == nullptr) return nullptr;
 
+  return World->GetSubsystem<UMovingPlatformSubsystem>();
 }
 
-void AMovingPlatform::BeginPlay()
+void AMovingPlatform::GetLifetimeReplicatedProps(TArray<FLifetimeProperty> &OutLifetimeProps) const
 {
-  Super::BeginPlay();
+  Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+  DOREPLIFETIME(AMovingPlatform, MotionAnchor);
+}
+
+void AMovingPlatform::UpdateActiveTriggers()
+{
+  UMovingPlatformSubsystem *PlatformSubsystem = GetPlatformSubsystem();
+  if (PlatformSubsystem == nullptr) return;
+
+  PlatformSubsystem->SetActiveTriggers(this, ActiveTriggers);
 
   if (HasAuthority())
   {
-    SetReplicates(true);
-    SetReplicateMovement(true);
+    MotionAnchor = PlatformSubsystem->GetMotionAnchor(this);
+    UpdateNetDormancy();
   }
+}
 
-  GlobalStartLocation = GetActorLocation();
-  GlobalTargetLocation = GetTransform().TransformPosition(TargetLocation);
+void AMovingPlatform::UpdateNetDormancy()
+{
+  // Idle platforms send their final anchor and then drop out of replication until triggered again
+  SetNetDormancy(ActiveTriggers > 0 ? DORM_Awake : DORM_DormantAll);
+}
+
+void AMovingPlatform::OnRep_MotionAnchor()
+{
+  ActiveTriggers = MotionAnchor.ActiveTriggers;
+
+  UMovingPlatformSubsystem *PlatformSubsystem = GetPlatformSubsystem();
+  if (PlatformSubsystem != nullptr)
+  {
+    PlatformSubsystem->SetMotionAnchor(this, MotionAnchor);
+  }
 }
@@ -6,6 +6,23 @@
 #include "Engine/StaticMeshActor.h"
 #include "MovingPlatform.generated.h"
 
+/** Replicated state clients need to evaluate a deterministic platform locally */
+USTRUCT()
+struct FPlatformMotionAnchor
+{
+  GENERATED_BODY()
+
+  UPROPERTY()
+  float ServerTime = 0.f;
+
+  // Distance travelled along the ping-pong cycle at ServerTime
+  UPROPERTY()
+  float Phase = 0.f;
+
+  UPROPERTY()
+  int32 ActiveTriggers = 0;
+};
+
 /**
  * 
  */
@@ -14,6 +31,8 @@ class PUZZLEPLATFORMS_API AMovingPlatform : public AStaticMeshActor
 {
   GENERATED_BODY()
 
+  friend class UMovingPlatformSubsystem;
+
 public:
   UPROPERTY(EditAnywhere)
   float Speed = 20;
@@ -21,13 +40,23 @@ public:
   UPROPERTY(EditAnywhere, Meta = (MakeEditWidget = true))
   FVector TargetLocation;
 
+  // Follow a shared multi-waypoint or spline route instead of moving towards TargetLocation
+  UPROPERTY(EditAnywhere)
+  class UPlatformRoute *Route = nullptr;
+
+  // Evaluate the position from server time on every machine instead of replicating movement.
+  // Lets characters standing on the platform predict their based movement on clients. Opt in per platform.
+  UPROPERTY(EditAnywhere)
+  bool bDeterministicMotion = false;
+
   AMovingPlatform();
-  virtual void Tick(float DeltaTime) override;
   void AddActiveTrigger();
   void RemoveActiveTrigger();
 
 protected:
   virtual void BeginPlay() override;
+  virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+  virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty> &OutLifetimeProps) const override;
 
 private:
   FVector GlobalTargetLocation;
@@ -35,4 +64,17 @@ private:
 
   UPROPERTY(EditAnywhere)
   int ActiveTriggers = 1;
+
+  UPROPERTY(ReplicatedUsing = OnRep_MotionAnchor)
+  FPlatformMotionAnchor MotionAnchor;
+
+  // Index into UMovingPlatformSubsystem's arrays, INDEX_NONE when not simulated
+  int32 PlatformSlot = INDEX_NONE;
+
+  class UMovingPlatformSubsystem *GetPlatformSubsystem() const;
+  void UpdateActiveTriggers();
+  void UpdateNetDormancy();
+
+  UFUNCTION()
+  void OnRep_MotionAnchor();
 };
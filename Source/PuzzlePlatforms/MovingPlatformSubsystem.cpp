@@ -0,0 +1,431 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "MovingPlatformSubsystem.h"
+#include "PuzzlePlatforms.h"
+#include "Engine/NetDriver.h"
+#include "GameFramework/GameStateBase.h"
+#include "GameFramework/PlayerController.h"
+#include "GameFramework/PlayerState.h"
+
+#include "PlatformField.h"
+#include "PlatformRoute.h"
+#include "PuzzlePlatformsReplicationGraph.h"
+
+namespace
+{
+    const float NetUpdateRatesInterval = 0.5f;
+    const float MinNetUpdateFrequency = 2.f;
+    const float MaxNetUpdateFrequency = 30.f;
+
+    // Platforms at or above this speed get the full rate when a viewer is close
+    const float FullRateSpeed = 200.f;
+    const float FullRateDistance = 1000.f;
+
+    const float MaxPredictionOffset = 0.5f;
+    const float PredictionOffsetInterpSpeed = 2.f;
+}
+
+void UMovingPlatformSubsystem::Deinitialize()
+{
+    for (AMovingPlatform *Platform : Platforms)
+    {
+        if (Platform != nullptr)
+        {
+            Platform->PlatformSlot = INDEX_NONE;
+        }
+    }
+
+    Platforms.Empty();
+    Fields.Empty();
+    StartLocations.Empty();
+    Directions.Empty();
+    JourneyLengths.Empty();
+    JourneyTravelled.Empty();
+    CycleLengths.Empty();
+    Routes.Empty();
+    RouteRotations.Empty();
+    RouteUsers.Empty();
+    Speeds.Empty();
+    AnchorTimes.Empty();
+    AnchorPhases.Empty();
+    ActiveTriggers.Empty();
+    NumActive = 0;
+    UpdateMemoryStat();
+
+    Super::Deinitialize();
+}
+
+void UMovingPlatformSubsystem::Tick(float DeltaTime)
+{
+    SCOPE_CYCLE_COUNTER(STAT_PlatformUpdate);
+
+    const double TickStart = FPlatformTime::Seconds();
+
+    UpdatePredictionOffset(DeltaTime);
+    const float Now = GetServerTime() + PredictionOffset;
+
+    float *Travelled = JourneyTravelled.GetData();
+    const float *Lengths = JourneyLengths.GetData();
+    const float *Cycles = CycleLengths.GetData();
+    const float *PlatformSpeeds = Speeds.GetData();
+    const float *Times = AnchorTimes.GetData();
+    const float *Phases = AnchorPhases.GetData();
+
+    // Ping-pong distance along each journey, kept branch free so it vectorizes.
+    // With a cycle of one length instead of two the same expression wraps around a loop.
+    for (int32 i = 0; i < NumActive; ++i)
+    {
+        const float Phase = Phases[i] + PlatformSpeeds[i] * (Now - Times[i]);
+        Travelled[i] = GetJourneyDistance(Phase, Lengths[i], Cycles[i]);
+    }
+
+    for (int32 i = 0; i < NumActive; ++i)
+    {
+        const FVector Location = GetLocation(i, Travelled[i]);
+        if (Location.Equals(Platforms[i]->GetActorLocation(), KINDA_SMALL_NUMBER)) continue;
+
+        Platforms[i]->SetActorLocation(Location);
+    }
+
+    for (APlatformField *Field : Fields)
+    {
+        Field->UpdateInstances(Now);
+    }
+
+    NetUpdateRatesTimeLeft -= DeltaTime;
+    if (NetUpdateRatesTimeLeft <= 0.f)
+    {
+        NetUpdateRatesTimeLeft = NetUpdateRatesInterval;
+        UpdateNetUpdateRates();
+    }
+
+    SET_DWORD_STAT(STAT_NumPlatforms, Platforms.Num());
+    SET_DWORD_STAT(STAT_NumActivePlatforms, NumActive);
+
+    LastTickMs = (FPlatformTime::Seconds() - TickStart) * 1000.0;
+}
+
+bool UMovingPlatformSubsystem::IsTickable() const
+{
+    return NumActive > 0 || Fields.Num() > 0;
+}
+
+TStatId UMovingPlatformSubsystem::GetStatId() const
+{
+    RETURN_QUICK_DECLARE_CYCLE_STAT(UMovingPlatformSubsystem, STATGROUP_Tickables);
+}
+
+UWorld *UMovingPlatformSubsystem::GetTickableGameObjectWorld() const
+{
+    return GetWorld();
+}
+
+void UMovingPlatformSubsystem::RegisterPlatform(AMovingPlatform *Platform, const FVector &Start, const FVector &Target, float Speed, int32 Triggers)
+{
+    if (!ensure(Platform != nullptr)) return;
+    if (Platform->PlatformSlot != INDEX_NONE) return;
+
+    const FVector Journey = Target - Start;
+    UPlatformRoute *Route = Platform->Route;
+    if (Route != nullptr)
+    {
+        Route->BuildLookupTable();
+        ++RouteUsers.FindOrAdd(Route);
+    }
+
+    const float Length = Route != nullptr ? Route->GetLength() : Journey.Size();
+    const bool bLoop = Route != nullptr && Route->bLoop;
+
+    Platform->PlatformSlot = Platforms.Add(Platform);
+    StartLocations.Add(Start);
+    Directions.Add(Journey.GetSafeNormal());
+    JourneyLengths.Add(Length);
+    JourneyTravelled.Add(0.f);
+    CycleLengths.Add(bLoop ? Length : 2.f * Length);
+    Routes.Add(Route);
+    RouteRotations.Add(Platform->GetActorQuat());
+    Speeds.Add(Speed);
+    AnchorTimes.Add(GetServerTime());
+    AnchorPhases.Add(0.f);
+    ActiveTriggers.Add(0);
+
+    SetActiveTriggers(Platform, Triggers);
+    UpdateMemoryStat();
+}
+
+void UMovingPlatformSubsystem::UnregisterPlatform(AMovingPlatform *Platform)
+{
+    if (Platform == nullptr || Platform->PlatformSlot == INDEX_NONE) return;
+
+    SetActiveTriggers(Platform, 0);
+
+    const int32 Slot = Platform->PlatformSlot;
+    SwapSlots(Slot, Platforms.Num() - 1);
+
+    const UPlatformRoute *Route = Routes.Last();
+    if (Route != nullptr && --RouteUsers.FindChecked(Route) == 0)
+    {
+        RouteUsers.Remove(Route);
+    }
+
+    Platforms.Pop(false);
+    StartLocations.Pop(false);
+    Directions.Pop(false);
+    JourneyLengths.Pop(false);
+    JourneyTravelled.Pop(false);
+    CycleLengths.Pop(false);
+    Routes.Pop(false);
+    RouteRotations.Pop(false);
+    Speeds.Pop(false);
+    AnchorTimes.Pop(false);
+    AnchorPhases.Pop(false);
+    ActiveTriggers.Pop(false);
+
+    Platform->PlatformSlot = INDEX_NONE;
+    UpdateMemoryStat();
+}
+
+void UMovingPlatformSubsystem::SetActiveTriggers(AMovingPlatform *Platform, int32 Triggers)
+{
+    if (Platform == nullptr || Platform->PlatformSlot == INDEX_NONE) return;
+
+    const int32 Slot = Platform->PlatformSlot;
+    const bool WasActive = Slot < NumActive;
+
+    ActiveTriggers[Slot] = Triggers;
+
+    // Re-anchor on start/stop so the phase carries over while the platform is idle
+    if (WasActive != ShouldBeActive(Slot))
+    {
+        const float Now = GetServerTime();
+        AnchorPhases[Slot] = GetPhase(Slot, Now);
+        AnchorTimes[Slot] = Now;
+    }
+
+    UpdateActiveRange(Slot);
+}
+
+void UMovingPlatformSubsystem::RegisterField(APlatformField *Field)
+{
+    if (!ensure(Field != nullptr)) return;
+
+    Fields.AddUnique(Field);
+    UpdateMemoryStat();
+}
+
+void UMovingPlatformSubsystem::UnregisterField(APlatformField *Field)
+{
+    Fields.RemoveSingleSwap(Field, false);
+    UpdateMemoryStat();
+}
+
+FPlatformMotionAnchor UMovingPlatformSubsystem::GetMotionAnchor(const AMovingPlatform *Platform) const
+{
+    FPlatformMotionAnchor Anchor;
+    if (Platform == nullptr || Platform->PlatformSlot == INDEX_NONE) return Anchor;
+
+    const int32 Slot = Platform->PlatformSlot;
+    Anchor.ServerTime = AnchorTimes[Slot];
+    Anchor.Phase = AnchorPhases[Slot];
+    Anchor.ActiveTriggers = ActiveTriggers[Slot];
+    return Anchor;
+}
+
+void UMovingPlatformSubsystem::SetMotionAnchor(AMovingPlatform *Platform, const FPlatformMotionAnchor &Anchor)
+{
+    if (Platform == nullptr || Platform->PlatformSlot == INDEX_NONE) return;
+
+    const int32 Slot = Platform->PlatformSlot;
+    AnchorTimes[Slot] = Anchor.ServerTime;
+    AnchorPhases[Slot] = Anchor.Phase;
+    ActiveTriggers[Slot] = Anchor.ActiveTriggers;
+
+    UpdateActiveRange(Slot);
+
+    // Snap idle platforms to their anchored position, active ones move on the next tick
+    if (Slot >= NumActive && JourneyLengths[Slot] > 0.f)
+    {
+        const float Distance = GetJourneyDistance(Anchor.Phase, JourneyLengths[Slot], CycleLengths[Slot]);
+        JourneyTravelled[Slot] = Distance;
+        Platform->SetActorLocation(GetLocation(Slot, Distance));
+    }
+}
+
+int32 UMovingPlatformSubsystem::GetNumDormantPlatforms() const
+{
+    int32 NumDormant = 0;
+    for (const AMovingPlatform *Platform : Platforms)
+    {
+        if (Platform != nullptr && Platform->NetDormancy > DORM_Awake)
+        {
+            ++NumDormant;
+        }
+    }
+    return NumDormant;
+}
+
+float UMovingPlatformSubsystem::GetServerTime() const
+{
+    UWorld *World = GetWorld();
+    if (World == nullptr) return 0.f;
+
+    AGameStateBase *GameState = World->GetGameState();
+    return GameState != nullptr ? GameState->GetServerWorldTimeSeconds() : World->GetTimeSeconds();
+}
+
+bool UMovingPlatformSubsystem::ShouldBeActive(int32 Slot) const
+{
+    return ActiveTriggers[Slot] > 0 && Speeds[Slot] != 0.f && JourneyLengths[Slot] > 0.f;
+}
+
+float UMovingPlatformSubsystem::GetPhase(int32 Slot, float Now) const
+{
+    if (JourneyLengths[Slot] <= 0.f) return 0.f;
+
+    float Phase = AnchorPhases[Slot];
+    if (Slot < NumActive)
+    {
+        Phase += Speeds[Slot] * (Now - AnchorTimes[Slot]);
+    }
+
+    // Keep the anchor within one cycle so float precision does not degrade over a long match
+    return WrapPhase(Phase, CycleLengths[Slot]);
+}
+
+FVector UMovingPlatformSubsystem::GetLocation(int32 Slot, float Distance) const
+{
+    const UPlatformRoute *Route = Routes[Slot];
+    if (Route == nullptr) return StartLocations[Slot] + Directions[Slot] * Distance;
+
+    return StartLocations[Slot] + RouteRotations[Slot].RotateVector(Route->Evaluate(Distance));
+}
+
+void UMovingPlatformSubsystem::UpdateActiveRange(int32 Slot)
+{
+    const bool WasActive = Slot < NumActive;
+    const bool IsActive = ShouldBeActive(Slot);
+
+    if (IsActive && !WasActive)
+    {
+        SwapSlots(Slot, NumActive);
+        ++NumActive;
+    }
+    else if (!IsActive && WasActive)
+    {
+        SwapSlots(Slot, NumActive - 1);
+        --NumActive;
+    }
+}
+
+void UMovingPlatformSubsystem::SwapSlots(int32 A, int32 B)
+{
+    if (A == B) return;
+
+    Platforms.Swap(A, B);
+    StartLocations.Swap(A, B);
+    Directions.Swap(A, B);
+    JourneyLengths.Swap(A, B);
+    JourneyTravelled.Swap(A, B);
+    CycleLengths.Swap(A, B);
+    Routes.Swap(A, B);
+    RouteRotations.Swap(A, B);
+    Speeds.Swap(A, B);
+    AnchorTimes.Swap(A, B);
+    AnchorPhases.Swap(A, B);
+    ActiveTriggers.Swap(A, B);
+
+    Platforms[A]->PlatformSlot = A;
+    Platforms[B]->PlatformSlot = B;
+}
+
+void UMovingPlatformSubsystem::UpdateNetUpdateRates()
+{
+    UWorld *World = GetWorld();
+    if (World == nullptr || World->GetNetMode() == NM_Client || World->GetNetDriver() == nullptr) return;
+
+    TArray<FVector, TInlineAllocator<16>> ViewLocations;
+    for (FConstPlayerControllerIterator It = World->GetPlayerControllerIterator(); It; ++It)
+    {
+        APlayerController *PlayerController = It->Get();
+        if (PlayerController == nullptr || PlayerController->Player == nullptr) continue;
+
+        FVector ViewLocation;
+        FRotator ViewRotation;
+        PlayerController->GetPlayerViewPoint(ViewLocation, ViewRotation);
+        ViewLocations.Add(ViewLocation);
+    }
+
+    UPuzzlePlatformsReplicationGraph *ReplicationGraph = Cast<UPuzzlePlatformsReplicationGraph>(World->GetNetDriver()->GetReplicationDriver());
+
+    // Idle platforms are dormant, only the active range needs a rate
+    for (int32 i = 0; i < NumActive; ++i)
+    {
+        AMovingPlatform *Platform = Platforms[i];
+
+        float Frequency = MinNetUpdateFrequency;
+        float Priority = 1.f;
+
+        // Deterministic platforms only replicate their anchor, which changes on trigger edges
+        if (!Platform->bDeterministicMotion)
+        {
+            float NearestDistanceSquared = MAX_flt;
+            for (const FVector &ViewLocation : ViewLocations)
+            {
+                NearestDistanceSquared = FMath::Min(NearestDistanceSquared, FVector::DistSquared(ViewLocation, Platform->GetActorLocation()));
+            }
+
+            const float CullDistance = FMath::Sqrt(Platform->NetCullDistanceSquared);
+            const float DistanceAlpha = 1.f - FMath::Clamp((FMath::Sqrt(NearestDistanceSquared) - FullRateDistance) / FMath::Max(CullDistance - FullRateDistance, 1.f), 0.f, 1.f);
+            const float SpeedAlpha = FMath::Clamp(FMath::Abs(Speeds[i]) / FullRateSpeed, 0.25f, 1.f);
+
+            Frequency = FMath::Lerp(MinNetUpdateFrequency, MaxNetUpdateFrequency, SpeedAlpha * DistanceAlpha);
+            Priority = FMath::Lerp(0.5f, 2.f, DistanceAlpha);
+        }
+
+        if (FMath::IsNearlyEqual(Platform->NetUpdateFrequency, Frequency, 0.5f) && FMath::IsNearlyEqual(Platform->NetPriority, Priority, 0.1f)) continue;
+
+        Platform->NetUpdateFrequency = Frequency;
+        Platform->NetPriority = Priority;
+
+        if (ReplicationGraph != nullptr)
+        {
+            ReplicationGraph->UpdateActorReplicationSettings(Platform);
+        }
+    }
+}
+
+void UMovingPlatformSubsystem::UpdatePredictionOffset(float DeltaTime)
+{
+    UWorld *World = GetWorld();
+    if (World == nullptr || World->GetNetMode() != NM_Client) return;
+
+    APlayerController *PlayerController = World->GetFirstPlayerController();
+    if (PlayerController == nullptr || PlayerController->PlayerState == nullptr) return;
+
+    // Replicated server time reaches us a one way trip late and our moves reach the server a
+    // one way trip later, so the platform the server bases those moves on is a round trip ahead
+    const float TargetOffset = FMath::Clamp(PlayerController->PlayerState->ExactPing * 0.001f, 0.f, MaxPredictionOffset);
+
+    // Ease towards the new ping so platforms do not jump when it changes
+    PredictionOffset = FMath::FInterpTo(PredictionOffset, TargetOffset, DeltaTime, PredictionOffsetInterpSpeed);
+}
+
+void UMovingPlatformSubsystem::UpdateMemoryStat() const
+{
+    SIZE_T FieldSize = Fields.GetAllocatedSize();
+    for (const APlatformField *Field : Fields)
+    {
+        FieldSize += Field->GetSimulationSize();
+    }
+
+    SIZE_T RouteSize = RouteUsers.GetAllocatedSize();
+    for (const TPair<const UPlatformRoute *, int32> &RouteUser : RouteUsers)
+    {
+        RouteSize += RouteUser.Key->GetLookupTableSize();
+    }
+
+    SET_MEMORY_STAT(STAT_PlatformMemory, FieldSize + RouteSize + Platforms.GetAllocatedSize() + StartLocations.GetAllocatedSize() + Directions.GetAllocatedSize()
+        + JourneyLengths.GetAllocatedSize() + JourneyTravelled.GetAllocatedSize() + CycleLengths.GetAllocatedSize()
+        + Routes.GetAllocatedSize() + RouteRotations.GetAllocatedSize() + Speeds.GetAllocatedSize()
+        + AnchorTimes.GetAllocatedSize() + AnchorPhases.GetAllocatedSize() + ActiveTriggers.GetAllocatedSize());
+}
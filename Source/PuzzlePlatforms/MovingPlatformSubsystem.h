@@ -0,0 +1,110 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+#include "MovingPlatform.h"
+#include "MovingPlatformSubsystem.generated.h"
+
+/**
+ * Moves every AMovingPlatform of the world in one batched pass per frame.
+ * Platform state is stored as a structure of arrays with the active platforms
+ * packed at the front, so idle platforms are never visited.
+ *
+ * Positions are a closed-form ping-pong of (server time - anchor time), so a
+ * client given the same anchor evaluates the same location as the server.
+ * Platforms with a UPlatformRoute look their position up in the route's shared
+ * arc length table instead of moving along a single segment.
+ * Platform fields are advanced in the same pass from the same clock.
+ * Clients evaluate slightly in the future so a character's based moves line up
+ * with where the platform is when the server replays them.
+ */
+UCLASS()
+class PUZZLEPLATFORMS_API UMovingPlatformSubsystem : public UWorldSubsystem, public FTickableGameObject
+{
+    GENERATED_BODY()
+
+public:
+    virtual void Deinitialize() override;
+
+    virtual void Tick(float DeltaTime) override;
+    virtual bool IsTickable() const override;
+    virtual TStatId GetStatId() const override;
+    virtual UWorld *GetTickableGameObjectWorld() const override;
+
+    void RegisterPlatform(class AMovingPlatform *Platform, const FVector &Start, const FVector &Target, float Speed, int32 Triggers);
+    void UnregisterPlatform(class AMovingPlatform *Platform);
+    void SetActiveTriggers(class AMovingPlatform *Platform, int32 Triggers);
+
+    void RegisterField(class APlatformField *Field);
+    void UnregisterField(class APlatformField *Field);
+
+    FPlatformMotionAnchor GetMotionAnchor(const class AMovingPlatform *Platform) const;
+    void SetMotionAnchor(class AMovingPlatform *Platform, const FPlatformMotionAnchor &Anchor);
+    float GetServerTime() const;
+
+    int32 GetNumPlatforms() const { return Platforms.Num(); }
+    int32 GetNumActivePlatforms() const { return NumActive; }
+    double GetLastTickMs() const { return LastTickMs; }
+    int32 GetNumDormantPlatforms() const;
+
+    /** Phase wrapped into [0, Cycle), also for negative phases from a clock behind the anchor or a negative speed */
+    static FORCEINLINE float WrapPhase(float Phase, float Cycle)
+    {
+        const float Wrapped = FMath::Fmod(Phase, Cycle);
+        // A select rather than a branch, so loops over this still vectorize
+        return Wrapped + (Wrapped < 0.f ? Cycle : 0.f);
+    }
+
+    /** Distance along a journey of Length, ping-ponging when Cycle is twice the length and looping when it is the length */
+    static FORCEINLINE float GetJourneyDistance(float Phase, float Length, float Cycle)
+    {
+        return Length - FMath::Abs(WrapPhase(Phase, Cycle) - Length);
+    }
+
+private:
+    UPROPERTY()
+    TArray<class AMovingPlatform *> Platforms;
+
+    UPROPERTY()
+    TArray<class APlatformField *> Fields;
+
+    TArray<FVector> StartLocations;
+    TArray<FVector> Directions;
+    TArray<float> JourneyLengths;
+    TArray<float> JourneyTravelled;
+
+    // Segment platforms ping-pong over twice their length, looped routes wrap at their length
+    TArray<float> CycleLengths;
+
+    // Null for single segment platforms. Kept alive by the platform's Route property.
+    TArray<const class UPlatformRoute *> Routes;
+    TArray<FQuat> RouteRotations;
+
+    // Platforms per distinct route, so each shared lookup table is counted once in the memory stat
+    TMap<const class UPlatformRoute *, int32> RouteUsers;
+
+    TArray<float> Speeds;
+    TArray<float> AnchorTimes;
+    TArray<float> AnchorPhases;
+    TArray<int32> ActiveTriggers;
+
+    // Slots [0, NumActive) hold the movable platforms with at least one active trigger
+    int32 NumActive = 0;
+    double LastTickMs = 0;
+    float NetUpdateRatesTimeLeft = 0.f;
+
+    // Clients run deterministic platforms ahead of the replicated server time, see UpdatePredictionOffset
+    float PredictionOffset = 0.f;
+
+    bool ShouldBeActive(int32 Slot) const;
+    float GetPhase(int32 Slot, float Now) const;
+    FVector GetLocation(int32 Slot, float Distance) const;
+    void UpdateActiveRange(int32 Slot);
+    void SwapSlots(int32 A, int32 B);
+    void UpdateNetUpdateRates();
+    void UpdatePredictionOffset(float DeltaTime);
+    void UpdateMemoryStat() const;
+};
@@ -0,0 +1,145 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "PlatformField.h"
+#include "PuzzlePlatforms.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "Engine/StaticMesh.h"
+#include "Net/UnrealNetwork.h"
+#include "UObject/ConstructorHelpers.h"
+
+#include "MovingPlatformSubsystem.h"
+
+APlatformField::APlatformField()
+{
+    // Instances are moved in batch by UMovingPlatformSubsystem
+    PrimaryActorTick.bCanEverTick = false;
+
+    bReplicates = true;
+    SetReplicatingMovement(false);
+
+    // Clients only need the instance list and anchor once
+    NetDormancy = DORM_Initial;
+
+    InstancedMesh = CreateDefaultSubobject<UInstancedStaticMeshComponent>(FName("InstancedMesh"));
+    if (!ensure(InstancedMesh != nullptr)) return;
+    RootComponent = InstancedMesh;
+
+    // Movable so characters standing on an instance use based movement
+    InstancedMesh->SetMobility(EComponentMobility::Movable);
+
+    static ConstructorHelpers::FObjectFinder<UStaticMesh> CubeMesh(TEXT("/Engine/BasicShapes/Cube.Cube"));
+    if (CubeMesh.Object != nullptr)
+    {
+        InstancedMesh->SetStaticMesh(CubeMesh.Object);
+    }
+}
+
+void APlatformField::BeginPlay()
+{
+    Super::BeginPlay();
+
+    UWorld *World = GetWorld();
+    if (!ensure(World != nullptr)) return;
+
+    UMovingPlatformSubsystem *PlatformSubsystem = World->GetSubsystem<UMovingPlatformSubsystem>();
+    if (!ensure(PlatformSubsystem != nullptr)) return;
+
+    if (HasAuthority())
+    {
+        AnchorTime = PlatformSubsystem->GetServerTime();
+
+        // Placed fields have to send their anchor once too, then nothing changes again
+        if (IsNetStartupActor())
+        {
+            FlushNetDormancy();
+        }
+        else
+        {
+            SetNetDormancy(DORM_DormantAll);
+        }
+    }
+
+    const int32 NumInstances = Instances.Num();
+    InstanceTransforms.Reset(NumInstances);
+    StartLocations.Reset(NumInstances);
+    Directions.Reset(NumInstances);
+    Lengths.Reset(NumInstances);
+    Speeds.Reset(NumInstances);
+    Phases.Reset(NumInstances);
+
+    for (const FPlatformFieldInstance &Instance : Instances)
+    {
+        const FVector Journey = Instance.TargetLocation - Instance.Transform.GetLocation();
+
+        InstanceTransforms.Add(Instance.Transform);
+        StartLocations.Add(Instance.Transform.GetLocation());
+        Directions.Add(Journey.GetSafeNormal());
+        // Never zero so the cycle can always be wrapped, a still instance has no direction anyway
+        Lengths.Add(FMath::Max(Journey.Size(), KINDA_SMALL_NUMBER));
+        Speeds.Add(Instance.Speed);
+        Phases.Add(Instance.Phase);
+    }
+
+    if (InstancedMesh != nullptr)
+    {
+        InstancedMesh->ClearInstances();
+        for (const FTransform &InstanceTransform : InstanceTransforms)
+        {
+            InstancedMesh->AddInstance(InstanceTransform);
+        }
+    }
+
+    PlatformSubsystem->RegisterField(this);
+}
+
+void APlatformField::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+    UWorld *World = GetWorld();
+    UMovingPlatformSubsystem *PlatformSubsystem = World != nullptr ? World->GetSubsystem<UMovingPlatformSubsystem>() : nullptr;
+    if (PlatformSubsystem != nullptr)
+    {
+        PlatformSubsystem->UnregisterField(this);
+    }
+
+    Super::EndPlay(EndPlayReason);
+}
+
+void APlatformField::GetLifetimeReplicatedProps(TArray<FLifetimeProperty> &OutLifetimeProps) const
+{
+    Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+    DOREPLIFETIME_CONDITION(APlatformField, Instances, COND_InitialOnly);
+    DOREPLIFETIME_CONDITION(APlatformField, AnchorTime, COND_InitialOnly);
+}
+
+void APlatformField::UpdateInstances(float Now)
+{
+    const int32 NumInstances = Lengths.Num();
+    if (NumInstances == 0 || InstancedMesh == nullptr) return;
+
+    // Same ping-pong as UMovingPlatformSubsystem, from the field's own anchor
+    const float Elapsed = Now - AnchorTime;
+    for (int32 i = 0; i < NumInstances; ++i)
+    {
+        const float Phase = Phases[i] + Speeds[i] * Elapsed;
+        const float Distance = UMovingPlatformSubsystem::GetJourneyDistance(Phase, Lengths[i], 2.f * Lengths[i]);
+        InstanceTransforms[i].SetTranslation(StartLocations[i] + Directions[i] * Distance);
+    }
+
+    // One render state update and one pass over the instance bodies for the whole field
+    InstancedMesh->BatchUpdateInstancesTransforms(0, InstanceTransforms, false, true, false);
+}
+
+bool APlatformField::GetInstanceLocation(int32 Index, FVector &OutLocation) const
+{
+    if (!InstanceTransforms.IsValidIndex(Index)) return false;
+
+    OutLocation = GetActorTransform().TransformPosition(InstanceTransforms[Index].GetLocation());
+    return true;
+}
+
+SIZE_T APlatformField::GetSimulationSize() const
+{
+    return InstanceTransforms.GetAllocatedSize() + StartLocations.GetAllocatedSize() + Directions.GetAllocatedSize()
+        + Lengths.GetAllocatedSize() + Speeds.GetAllocatedSize() + Phases.GetAllocatedSize();
+}
@@ -0,0 +1,73 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "PlatformField.generated.h"
+
+USTRUCT()
+struct FPlatformFieldInstance
+{
+    GENERATED_BODY()
+
+    // Start of the journey, relative to the field
+    UPROPERTY(EditAnywhere, Meta = (MakeEditWidget = true))
+    FTransform Transform;
+
+    UPROPERTY(EditAnywhere, Meta = (MakeEditWidget = true))
+    FVector TargetLocation = FVector::ZeroVector;
+
+    UPROPERTY(EditAnywhere)
+    float Speed = 20.f;
+
+    // Distance along the ping-pong cycle at the field's anchor time, staggers otherwise identical platforms
+    UPROPERTY(EditAnywhere)
+    float Phase = 0.f;
+};
+
+/**
+ * Many always moving platforms drawn and collided through one instanced mesh component,
+ * for crowded maps where an AMovingPlatform per platform is too many actors and channels.
+ *
+ * Instances ping-pong from server time like deterministic AMovingPlatforms, so nothing
+ * replicates after the instance list and the time the field started moving.
+ * UMovingPlatformSubsystem updates every field's instance transforms in one batch per frame.
+ */
+UCLASS()
+class PUZZLEPLATFORMS_API APlatformField : public AActor
+{
+    GENERATED_BODY()
+
+public:
+    APlatformField();
+
+    UPROPERTY(EditAnywhere, Replicated)
+    TArray<FPlatformFieldInstance> Instances;
+
+    void UpdateInstances(float Now);
+    bool GetInstanceLocation(int32 Index, FVector &OutLocation) const;
+    int32 GetNumInstances() const { return Lengths.Num(); }
+    SIZE_T GetSimulationSize() const;
+
+protected:
+    virtual void BeginPlay() override;
+    virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+    virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty> &OutLifetimeProps) const override;
+
+private:
+    UPROPERTY(VisibleAnywhere)
+    class UInstancedStaticMeshComponent *InstancedMesh;
+
+    // Server time the instance phases are measured from, keeps the elapsed time small
+    UPROPERTY(Replicated)
+    float AnchorTime = 0.f;
+
+    // Field space simulation state, one entry per instance
+    TArray<FTransform> InstanceTransforms;
+    TArray<FVector> StartLocations;
+    TArray<FVector> Directions;
+    TArray<float> Lengths;
+    TArray<float> Speeds;
+    TArray<float> Phases;
+};
@@ -0,0 +1,110 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "PlatformRoute.h"
+#include "PuzzlePlatforms.h"
+
+namespace
+{
+    // Caps the table at ~48KB however long the route or fine the spacing
+    const int32 MaxLookupIntervals = 4096;
+}
+
+void UPlatformRoute::BuildLookupTable()
+{
+    if (HasLookupTable()) return;
+
+    TArray<FVector> Path;
+    SamplePath(Path);
+
+    TArray<float> PathDistances;
+    PathDistances.Reserve(Path.Num());
+    PathDistances.Add(0.f);
+    for (int32 i = 1; i < Path.Num(); ++i)
+    {
+        PathDistances.Add(PathDistances.Last() + FVector::Dist(Path[i - 1], Path[i]));
+    }
+    Length = PathDistances.Last();
+
+    const int32 NumIntervals = FMath::Clamp(FMath::CeilToInt(Length / FMath::Max(LookupSpacing, 1.f)), 1, MaxLookupIntervals);
+    const float Spacing = Length / NumIntervals;
+    InvLookupSpacing = Spacing > 0.f ? 1.f / Spacing : 0.f;
+
+    // Walk the sampled path once, dropping a point every Spacing along it
+    LookupPoints.Reset(NumIntervals + 1);
+    int32 Segment = 0;
+    for (int32 i = 0; i <= NumIntervals; ++i)
+    {
+        const float Distance = i * Spacing;
+        while (Segment < Path.Num() - 2 && PathDistances[Segment + 1] < Distance)
+        {
+            ++Segment;
+        }
+
+        const float SegmentLength = PathDistances[Segment + 1] - PathDistances[Segment];
+        const float Alpha = SegmentLength > 0.f ? FMath::Clamp((Distance - PathDistances[Segment]) / SegmentLength, 0.f, 1.f) : 0.f;
+        LookupPoints.Add(FMath::Lerp(Path[Segment], Path[Segment + 1], Alpha));
+    }
+
+    UE_LOG(LogPuzzlePlatforms, Verbose, TEXT("Built route %s: %.0f long, %d lookup points"), *GetName(), Length, LookupPoints.Num());
+}
+
+void UPlatformRoute::SamplePath(TArray<FVector> &OutPoints) const
+{
+    // The platform's own location starts the route
+    TArray<FVector> Controls;
+    Controls.Reserve(Waypoints.Num() + 1);
+    Controls.Add(FVector::ZeroVector);
+    Controls.Append(Waypoints);
+
+    const int32 NumControls = Controls.Num();
+    const int32 NumSegments = bLoop ? NumControls : NumControls - 1;
+
+    auto GetControl = [&](int32 Index)
+    {
+        return bLoop ? Controls[(Index % NumControls + NumControls) % NumControls] : Controls[FMath::Clamp(Index, 0, NumControls - 1)];
+    };
+
+    if (!bSmooth)
+    {
+        for (int32 i = 0; i <= NumSegments; ++i)
+        {
+            OutPoints.Add(GetControl(i));
+        }
+    }
+    else
+    {
+        for (int32 i = 0; i < NumSegments; ++i)
+        {
+            const FVector P0 = GetControl(i - 1);
+            const FVector P1 = GetControl(i);
+            const FVector P2 = GetControl(i + 1);
+            const FVector P3 = GetControl(i + 2);
+            const FVector T1 = (P2 - P0) * 0.5f;
+            const FVector T2 = (P3 - P1) * 0.5f;
+
+            for (int32 Sample = 0; Sample < SamplesPerSegment; ++Sample)
+            {
+                OutPoints.Add(FMath::CubicInterp(P1, T1, P2, T2, (float)Sample / SamplesPerSegment));
+            }
+        }
+        OutPoints.Add(GetControl(NumSegments));
+    }
+
+    // A route without waypoints stays put, but still needs one segment to evaluate
+    if (OutPoints.Num() < 2)
+    {
+        OutPoints.Add(FVector::ZeroVector);
+    }
+}
+
+#if WITH_EDITOR
+void UPlatformRoute::PostEditChangeProperty(FPropertyChangedEvent &PropertyChangedEvent)
+{
+    Super::PostEditChangeProperty(PropertyChangedEvent);
+
+    // Rebuilt by the next platform that begins play with this route
+    LookupPoints.Empty();
+    Length = 0.f;
+    InvLookupSpacing = 0.f;
+}
+#endif
@@ -0,0 +1,65 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataAsset.h"
+#include "PlatformRoute.generated.h"
+
+/**
+ * A multi-waypoint or spline path shared by any number of AMovingPlatform instances.
+ *
+ * The path is resampled once into points spaced evenly by arc length, so a distance
+ * along the route maps straight to a table index and a lerp: no search and no square root.
+ */
+UCLASS(BlueprintType)
+class PUZZLEPLATFORMS_API UPlatformRoute : public UPrimaryDataAsset
+{
+    GENERATED_BODY()
+
+public:
+    // Points visited after the platform's own location, relative to it and rotated with it
+    UPROPERTY(EditAnywhere, Category = "Route")
+    TArray<FVector> Waypoints;
+
+    // Follow a Catmull-Rom spline through the waypoints instead of straight segments
+    UPROPERTY(EditAnywhere, Category = "Route")
+    bool bSmooth = false;
+
+    // Return to the start and go round again instead of reversing at the last waypoint
+    UPROPERTY(EditAnywhere, Category = "Route")
+    bool bLoop = false;
+
+    UPROPERTY(EditAnywhere, Category = "Route", AdvancedDisplay, Meta = (ClampMin = 2))
+    int32 SamplesPerSegment = 16;
+
+    // Spacing of the lookup table, smaller is more accurate on tight curves
+    UPROPERTY(EditAnywhere, Category = "Route", AdvancedDisplay, Meta = (ClampMin = 1))
+    float LookupSpacing = 10.f;
+
+    // Safe to call from every platform using the route, the table is only built once
+    void BuildLookupTable();
+
+    bool HasLookupTable() const { return LookupPoints.Num() > 0; }
+    float GetLength() const { return Length; }
+    SIZE_T GetLookupTableSize() const { return LookupPoints.GetAllocatedSize(); }
+
+    /** Route space position at Distance, which must be within [0, GetLength()] */
+    FORCEINLINE FVector Evaluate(float Distance) const
+    {
+        const float Scaled = Distance * InvLookupSpacing;
+        const int32 Index = FMath::Clamp(FMath::TruncToInt(Scaled), 0, LookupPoints.Num() - 2);
+        return FMath::Lerp(LookupPoints[Index], LookupPoints[Index + 1], Scaled - Index);
+    }
+
+#if WITH_EDITOR
+    virtual void PostEditChangeProperty(FPropertyChangedEvent &PropertyChangedEvent) override;
+#endif
+
+private:
+    TArray<FVector> LookupPoints;
+    float Length = 0.f;
+    float InvLookupSpacing = 0.f;
+
+    void SamplePath(TArray<FVector> &OutPoints) const;
+};
@@ -0,0 +1,27 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "PlatformSignalGate.h"
+#include "Components/SceneComponent.h"
+
+#include "PlatformSignalSubsystem.h"
+
+APlatformSignalGate::APlatformSignalGate()
+{
+    PrimaryActorTick.bCanEverTick = false;
+
+    RootComponent = CreateDefaultSubobject<USceneComponent>(FName("Root"));
+}
+
+void APlatformSignalGate::BeginPlay()
+{
+    Super::BeginPlay();
+
+    UPlatformSignalSubsystem::MarkGraphDirty(GetWorld());
+}
+
+void APlatformSignalGate::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+    UPlatformSignalSubsystem::MarkGraphDirty(GetWorld());
+
+    Super::EndPlay(EndPlayReason);
+}
@@ -0,0 +1,50 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "PlatformSignalGate.generated.h"
+
+UENUM()
+enum class EPlatformSignalGateType : uint8
+{
+    // On while any input is on
+    Or,
+    // On while every input is on
+    And,
+    // On from the first time any input is on, for the rest of the match
+    Latch
+};
+
+/**
+ * Combines the signals of triggers and other gates before they reach platforms.
+ * Has no behaviour of its own, UPlatformSignalSubsystem compiles the gates into its graph.
+ */
+UCLASS()
+class PUZZLEPLATFORMS_API APlatformSignalGate : public AActor
+{
+    GENERATED_BODY()
+
+    friend class UPlatformSignalSubsystem;
+
+public:
+    APlatformSignalGate();
+
+    UPROPERTY(EditAnywhere)
+    EPlatformSignalGateType GateType = EPlatformSignalGateType::Or;
+
+    UPROPERTY(EditAnywhere)
+    TArray<class AMovingPlatform *> PlatformsToTrigger;
+
+    UPROPERTY(EditAnywhere)
+    TArray<APlatformSignalGate *> GatesToSignal;
+
+protected:
+    virtual void BeginPlay() override;
+    virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+private:
+    // Survives the graph being recompiled when actors come and go
+    bool bLatched = false;
+};
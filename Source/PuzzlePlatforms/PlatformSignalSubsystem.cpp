@@ -0,0 +1,338 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "PlatformSignalSubsystem.h"
+#include "PuzzlePlatforms.h"
+#include "EngineUtils.h"
+
+#include "MovingPlatform.h"
+#include "PlatformSignalGate.h"
+#include "PlatformTrigger.h"
+
+void UPlatformSignalSubsystem::Deinitialize()
+{
+    NodeActors.Empty();
+    NodeTypes.Empty();
+    NodeInputs.Empty();
+    NodeActiveInputs.Empty();
+    NodeOutputs.Empty();
+    NodeDirty.Empty();
+    NodeEdgeStarts.Empty();
+    NodeEdgeTargets.Empty();
+    PlatformEdgeStarts.Empty();
+    PlatformEdgeTargets.Empty();
+    Platforms.Empty();
+    PlatformActiveInputs.Empty();
+    PlatformSignalled.Empty();
+    PlatformDirty.Empty();
+    ChangedPlatforms.Empty();
+    GraphDirty = false;
+    FirstDirtyNode = INDEX_NONE;
+
+    Super::Deinitialize();
+}
+
+void UPlatformSignalSubsystem::Tick(float DeltaTime)
+{
+    SCOPE_CYCLE_COUNTER(STAT_SignalGraph);
+
+    if (GraphDirty)
+    {
+        CompileGraph();
+    }
+
+    EvaluateGraph();
+}
+
+bool UPlatformSignalSubsystem::IsTickable() const
+{
+    return GraphDirty || FirstDirtyNode != INDEX_NONE || ChangedPlatforms.Num() > 0;
+}
+
+TStatId UPlatformSignalSubsystem::GetStatId() const
+{
+    RETURN_QUICK_DECLARE_CYCLE_STAT(UPlatformSignalSubsystem, STATGROUP_Tickables);
+}
+
+UWorld *UPlatformSignalSubsystem::GetTickableGameObjectWorld() const
+{
+    return GetWorld();
+}
+
+void UPlatformSignalSubsystem::MarkGraphDirty(UWorld *World)
+{
+    UPlatformSignalSubsystem *SignalSubsystem = World != nullptr ? World->GetSubsystem<UPlatformSignalSubsystem>() : nullptr;
+    if (SignalSubsystem == nullptr) return;
+
+    SignalSubsystem->GraphDirty = true;
+}
+
+void UPlatformSignalSubsystem::QueueTriggerEdge(APlatformTrigger *Trigger, bool Occupied)
+{
+    if (Trigger == nullptr) return;
+
+    // Not compiled in yet, the compile reads the trigger's occupancy itself
+    const int32 Node = Trigger->SignalNode;
+    if (GraphDirty || !NodeActors.IsValidIndex(Node) || NodeActors[Node] != Trigger)
+    {
+        GraphDirty = true;
+        return;
+    }
+
+    // Only the last edge of the frame counts
+    NodeActiveInputs[Node] = Occupied ? 1 : 0;
+    MarkNodeDirty(Node);
+}
+
+void UPlatformSignalSubsystem::CompileGraph()
+{
+    GraphDirty = false;
+
+    UWorld *World = GetWorld();
+    if (World == nullptr) return;
+
+    // Carried over so recompiling does not stop or restart platforms that are already signalled
+    TSet<AMovingPlatform *> SignalledPlatforms;
+    for (int32 i = 0; i < Platforms.Num(); ++i)
+    {
+        if (PlatformSignalled[i] && IsValid(Platforms[i]))
+        {
+            SignalledPlatforms.Add(Platforms[i]);
+        }
+    }
+
+    TArray<AActor *> Sources;
+    TMap<AActor *, int32> SourceIndices;
+    for (TActorIterator<APlatformTrigger> It(World); It; ++It)
+    {
+        if (!It->HasActorBegunPlay() || It->IsPendingKillPending()) continue;
+        SourceIndices.Add(*It, Sources.Add(*It));
+    }
+    for (TActorIterator<APlatformSignalGate> It(World); It; ++It)
+    {
+        if (!It->HasActorBegunPlay() || It->IsPendingKillPending()) continue;
+        SourceIndices.Add(*It, Sources.Add(*It));
+    }
+
+    TArray<TArray<int32>> Successors;
+    Successors.SetNum(Sources.Num());
+    TArray<int32> InDegrees;
+    InDegrees.SetNumZeroed(Sources.Num());
+
+    for (int32 i = 0; i < Sources.Num(); ++i)
+    {
+        APlatformTrigger *Trigger = Cast<APlatformTrigger>(Sources[i]);
+        const TArray<APlatformSignalGate *> &Gates = Trigger != nullptr ? Trigger->GatesToSignal : CastChecked<APlatformSignalGate>(Sources[i])->GatesToSignal;
+
+        for (APlatformSignalGate *Gate : Gates)
+        {
+            const int32 *Target = SourceIndices.Find(Gate);
+            if (Target == nullptr || *Target == i || Successors[i].Contains(*Target)) continue;
+
+            Successors[i].Add(*Target);
+            ++InDegrees[*Target];
+        }
+    }
+
+    // Kahn's algorithm, anything left over sits on a cycle
+    TArray<int32> Order;
+    Order.Reserve(Sources.Num());
+    for (int32 i = 0; i < Sources.Num(); ++i)
+    {
+        if (InDegrees[i] == 0) Order.Add(i);
+    }
+    for (int32 Head = 0; Head < Order.Num(); ++Head)
+    {
+        for (int32 Target : Successors[Order[Head]])
+        {
+            if (--InDegrees[Target] == 0) Order.Add(Target);
+        }
+    }
+    if (Order.Num() < Sources.Num())
+    {
+        UE_LOG(LogPuzzlePlatforms, Warning, TEXT("Platform signal gates form a cycle, the edges closing it are ignored"));
+        for (int32 i = 0; i < Sources.Num(); ++i)
+        {
+            if (InDegrees[i] > 0) Order.Add(i);
+        }
+    }
+
+    TArray<int32> SortedIndices;
+    SortedIndices.SetNumUninitialized(Sources.Num());
+    for (int32 i = 0; i < Order.Num(); ++i)
+    {
+        SortedIndices[Order[i]] = i;
+    }
+
+    const int32 NumNodes = Order.Num();
+    NodeActors.Reset(NumNodes);
+    NodeTypes.Reset(NumNodes);
+    NodeEdgeStarts.Reset(NumNodes + 1);
+    NodeEdgeTargets.Reset();
+    PlatformEdgeStarts.Reset(NumNodes + 1);
+    PlatformEdgeTargets.Reset();
+    Platforms.Reset();
+
+    TMap<AMovingPlatform *, int32> PlatformIndices;
+    for (int32 i = 0; i < NumNodes; ++i)
+    {
+        const int32 Source = Order[i];
+        APlatformTrigger *Trigger = Cast<APlatformTrigger>(Sources[Source]);
+        APlatformSignalGate *Gate = Cast<APlatformSignalGate>(Sources[Source]);
+
+        NodeActors.Add(Sources[Source]);
+        if (Trigger != nullptr)
+        {
+            Trigger->SignalNode = i;
+            NodeTypes.Add(ENodeType::Trigger);
+        }
+        else
+        {
+            NodeTypes.Add(Gate->GateType == EPlatformSignalGateType::And ? ENodeType::And : Gate->GateType == EPlatformSignalGateType::Latch ? ENodeType::Latch : ENodeType::Or);
+        }
+
+        // Backward edges only exist on cycles, forward ones keep the evaluation a single pass
+        NodeEdgeStarts.Add(NodeEdgeTargets.Num());
+        for (int32 Target : Successors[Source])
+        {
+            if (SortedIndices[Target] > i) NodeEdgeTargets.Add(SortedIndices[Target]);
+        }
+
+        PlatformEdgeStarts.Add(PlatformEdgeTargets.Num());
+        for (AMovingPlatform *Platform : Trigger != nullptr ? Trigger->PlatformsToTrigger : Gate->PlatformsToTrigger)
+        {
+            if (!IsValid(Platform)) continue;
+
+            const int32 *Index = PlatformIndices.Find(Platform);
+            PlatformEdgeTargets.Add(Index != nullptr ? *Index : PlatformIndices.Add(Platform, Platforms.Add(Platform)));
+        }
+    }
+    NodeEdgeStarts.Add(NodeEdgeTargets.Num());
+    PlatformEdgeStarts.Add(PlatformEdgeTargets.Num());
+
+    NodeInputs.Init(0, NumNodes);
+    NodeActiveInputs.Init(0, NumNodes);
+    NodeOutputs.Init(0, NumNodes);
+    NodeDirty.Init(1, NumNodes);
+    for (int32 Target : NodeEdgeTargets)
+    {
+        ++NodeInputs[Target];
+    }
+    for (int32 i = 0; i < NumNodes; ++i)
+    {
+        if (NodeTypes[i] != ENodeType::Trigger) continue;
+
+        NodeInputs[i] = 1;
+        NodeActiveInputs[i] = CastChecked<APlatformTrigger>(NodeActors[i])->IsOccupied() ? 1 : 0;
+    }
+    FirstDirtyNode = NumNodes > 0 ? 0 : INDEX_NONE;
+
+    // Every platform is rechecked once, outputs start off and are rebuilt by the first evaluation
+    const int32 NumPlatforms = Platforms.Num();
+    PlatformActiveInputs.Init(0, NumPlatforms);
+    PlatformSignalled.SetNumUninitialized(NumPlatforms);
+    PlatformDirty.Init(1, NumPlatforms);
+    ChangedPlatforms.Reset(NumPlatforms);
+    for (int32 i = 0; i < NumPlatforms; ++i)
+    {
+        PlatformSignalled[i] = SignalledPlatforms.Remove(Platforms[i]) > 0 ? 1 : 0;
+        ChangedPlatforms.Add(i);
+    }
+
+    // Platforms no longer wired to anything lose their signal
+    for (AMovingPlatform *Platform : SignalledPlatforms)
+    {
+        Platform->RemoveActiveTrigger();
+    }
+
+    UE_LOG(LogPuzzlePlatforms, Verbose, TEXT("Compiled platform signal graph: %d nodes, %d gate edges, %d platform edges, %d platforms"),
+        NumNodes, NodeEdgeTargets.Num(), PlatformEdgeTargets.Num(), NumPlatforms);
+}
+
+void UPlatformSignalSubsystem::EvaluateGraph()
+{
+    if (FirstDirtyNode != INDEX_NONE)
+    {
+        // Edges only point forward, so one sweep from the first dirty node settles everything
+        for (int32 Node = FirstDirtyNode; Node < NodeTypes.Num(); ++Node)
+        {
+            if (!NodeDirty[Node]) continue;
+            NodeDirty[Node] = 0;
+
+            const bool Output = GetNodeOutput(Node);
+            if (Output == (NodeOutputs[Node] != 0)) continue;
+
+            NodeOutputs[Node] = Output ? 1 : 0;
+            const int32 Delta = Output ? 1 : -1;
+
+            APlatformSignalGate *Gate = Cast<APlatformSignalGate>(NodeActors[Node]);
+            if (Output && Gate != nullptr && NodeTypes[Node] == ENodeType::Latch)
+            {
+                Gate->bLatched = true;
+            }
+
+            for (int32 Edge = NodeEdgeStarts[Node]; Edge < NodeEdgeStarts[Node + 1]; ++Edge)
+            {
+                NodeActiveInputs[NodeEdgeTargets[Edge]] += Delta;
+                NodeDirty[NodeEdgeTargets[Edge]] = 1;
+            }
+
+            for (int32 Edge = PlatformEdgeStarts[Node]; Edge < PlatformEdgeStarts[Node + 1]; ++Edge)
+            {
+                const int32 Platform = PlatformEdgeTargets[Edge];
+                PlatformActiveInputs[Platform] += Delta;
+                if (!PlatformDirty[Platform])
+                {
+                    PlatformDirty[Platform] = 1;
+                    ChangedPlatforms.Add(Platform);
+                }
+            }
+        }
+        FirstDirtyNode = INDEX_NONE;
+    }
+
+    // A graph signal counts as one trigger on the platform however many inputs feed it
+    for (int32 Platform : ChangedPlatforms)
+    {
+        PlatformDirty[Platform] = 0;
+
+        const bool Signalled = PlatformActiveInputs[Platform] > 0;
+        if (Signalled == (PlatformSignalled[Platform] != 0)) continue;
+
+        PlatformSignalled[Platform] = Signalled ? 1 : 0;
+        if (!IsValid(Platforms[Platform])) continue;
+
+        if (Signalled)
+        {
+            Platforms[Platform]->AddActiveTrigger();
+        }
+        else
+        {
+            Platforms[Platform]->RemoveActiveTrigger();
+        }
+    }
+    ChangedPlatforms.Reset();
+}
+
+void UPlatformSignalSubsystem::MarkNodeDirty(int32 Node)
+{
+    NodeDirty[Node] = 1;
+    FirstDirtyNode = FirstDirtyNode == INDEX_NONE ? Node : FMath::Min(FirstDirtyNode, Node);
+}
+
+bool UPlatformSignalSubsystem::GetNodeOutput(int32 Node) const
+{
+    switch (NodeTypes[Node])
+    {
+    case ENodeType::And:
+        return NodeInputs[Node] > 0 && NodeActiveInputs[Node] == NodeInputs[Node];
+
+    case ENodeType::Latch:
+    {
+        const APlatformSignalGate *Gate = Cast<APlatformSignalGate>(NodeActors[Node]);
+        return NodeActiveInputs[Node] > 0 || (Gate != nullptr && Gate->bLatched);
+    }
+
+    default:
+        return NodeActiveInputs[Node] > 0;
+    }
+}
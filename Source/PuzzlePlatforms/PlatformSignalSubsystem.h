@@ -0,0 +1,77 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+#include "PlatformSignalSubsystem.generated.h"
+
+/**
+ * Carries trigger signals through gates to platforms.
+ *
+ * Triggers and gates are compiled into flat arrays sorted so every edge points forward,
+ * whenever one of them begins or ends play. Triggers only queue their new occupancy;
+ * once per frame the dirty part of the graph is evaluated in a single forward pass and
+ * only platforms whose activation changed are touched, so a burst of overlaps on one
+ * pad costs one evaluation and an on-off flicker within a frame costs nothing.
+ */
+UCLASS()
+class PUZZLEPLATFORMS_API UPlatformSignalSubsystem : public UWorldSubsystem, public FTickableGameObject
+{
+    GENERATED_BODY()
+
+public:
+    virtual void Deinitialize() override;
+
+    virtual void Tick(float DeltaTime) override;
+    virtual bool IsTickable() const override;
+    virtual TStatId GetStatId() const override;
+    virtual UWorld *GetTickableGameObjectWorld() const override;
+
+    static void MarkGraphDirty(UWorld *World);
+    void QueueTriggerEdge(class APlatformTrigger *Trigger, bool Occupied);
+
+    int32 GetNumNodes() const { return NodeTypes.Num(); }
+
+private:
+    enum class ENodeType : uint8
+    {
+        Trigger,
+        Or,
+        And,
+        Latch
+    };
+
+    // Triggers and gates, in topological order
+    UPROPERTY()
+    TArray<AActor *> NodeActors;
+
+    TArray<ENodeType> NodeTypes;
+    TArray<int32> NodeInputs;
+    TArray<int32> NodeActiveInputs;
+    TArray<uint8> NodeOutputs;
+    TArray<uint8> NodeDirty;
+
+    // Outgoing edges of node i are [NodeEdgeStarts[i], NodeEdgeStarts[i + 1])
+    TArray<int32> NodeEdgeStarts;
+    TArray<int32> NodeEdgeTargets;
+    TArray<int32> PlatformEdgeStarts;
+    TArray<int32> PlatformEdgeTargets;
+
+    UPROPERTY()
+    TArray<class AMovingPlatform *> Platforms;
+
+    TArray<int32> PlatformActiveInputs;
+    TArray<uint8> PlatformSignalled;
+    TArray<uint8> PlatformDirty;
+    TArray<int32> ChangedPlatforms;
+
+    bool GraphDirty = false;
+    int32 FirstDirtyNode = INDEX_NONE;
+
+    void CompileGraph();
+    void EvaluateGraph();
+    void MarkNodeDirty(int32 Node);
+    bool GetNodeOutput(int32 Node) const;
+};
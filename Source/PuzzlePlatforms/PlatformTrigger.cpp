@@ -1,29 +1,42 @@
 // Fill out your copyright notice in the Description page of Project Settings.
 
 #include "PlatformTrigger.h"
+#include "PuzzlePlatforms.h"
 #include "Components/BoxComponent.h"
-#include "Components/AudioComponent.h"
 #include "Components/StaticMeshComponent.h"
+#include "GameFramework/GameStateBase.h"
 #include "Kismet/GameplayStatics.h"
-#include "MovingPlatform.h"
+#include "Net/UnrealNetwork.h"
+#include "PlatformSignalSubsystem.h"
+#include "TriggerAudioSubsystem.h"
+
+int32 APlatformTrigger::NumAnimatingTriggers = 0;
+
+// Presses replicated later than this are old state, not something the player just saw happen
+static const float PressSoundMaxDelay = 1.f;
 
 // Sets default values
 APlatformTrigger::APlatformTrigger()
 {
-    // Set this actor to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
+    // Only ticks while the pressure pad is moving between its rest and pressed positions
     PrimaryActorTick.bCanEverTick = true;
+    PrimaryActorTick.bStartWithTickEnabled = false;
+
+    // The pad state is flushed to clients when it changes and the trigger stays dormant otherwise
+    bReplicates = true;
+    SetReplicatingMovement(false);
+    NetDormancy = DORM_Initial;
 
     TriggerVolume = CreateDefaultSubobject<UBoxComponent>(FName("TriggerVolume"));
     if (!ensure(TriggerVolume != nullptr)) return;
     RootComponent = TriggerVolume;
 
+    // Only pawns and pushable objects overlap this profile, see DefaultEngine.ini
+    TriggerVolume->SetCollisionProfileName(FName("PlatformTrigger"));
+
     TriggerVolume->OnComponentBeginOverlap.AddDynamic(this, &APlatformTrigger::OnOverlapBegin);
     TriggerVolume->OnComponentEndOverlap.AddDynamic(this, &APlatformTrigger::OnOverlapEnd);
 
-    TriggerAudioComponent = CreateDefaultSubobject<UAudioComponent>(FName("TriggerAudioComponent"));
-    if (!ensure(TriggerAudioComponent != nullptr)) return;
-    TriggerAudioComponent->SetupAttachment(RootComponent);
-
     PressurePad = CreateDefaultSubobject<UStaticMeshComponent>(FName("PressurePad"));
     if (!ensure(PressurePad != nullptr)) return;
     PressurePad->SetupAttachment(RootComponent);
@@ -34,24 +47,35 @@ void APlatformTrigger::Tick(float DeltaTime)
 {
     Super::Tick(DeltaTime);
 
-    if (PressurePad != nullptr)
+    if (PressurePad == nullptr)
     {
-        FVector PressurePadLocation = PressurePad->GetRelativeLocation();
+        SetPressurePadAnimating(false);
+        return;
+    }
 
-        if (PressurePadActive)
-        {
-            PressurePadCurrentZ = FMath::FInterpConstantTo(PressurePadCurrentZ, PressurePadInitialZ - 8.f, DeltaTime, 30);
-        }
-        else
-        {
-            PressurePadCurrentZ = FMath::FInterpConstantTo(PressurePadCurrentZ, PressurePadInitialZ, DeltaTime, 30);
-        }
+    const float TargetZ = PressurePadActive ? PressurePadInitialZ - 8.f : PressurePadInitialZ;
+    PressurePadCurrentZ = FMath::FInterpConstantTo(PressurePadCurrentZ, TargetZ, DeltaTime, 30);
+    if (FMath::IsNearlyEqual(PressurePadCurrentZ, TargetZ))
+    {
+        PressurePadCurrentZ = TargetZ;
+    }
 
-        PressurePadLocation.Z = PressurePadCurrentZ;
-        PressurePad->SetRelativeLocation(PressurePadLocation);
+    FVector PressurePadLocation = PressurePad->GetRelativeLocation();
+    PressurePadLocation.Z = PressurePadCurrentZ;
+    PressurePad->SetRelativeLocation(PressurePadLocation);
+
+    if (PressurePadCurrentZ == TargetZ)
+    {
+        SetPressurePadAnimating(false);
     }
 }
 
+void APlatformTrigger::AddPlatformToTrigger(AMovingPlatform *Platform)
+{
+    PlatformsToTrigger.AddUnique(Platform);
+    UPlatformSignalSubsystem::MarkGraphDirty(GetWorld());
+}
+
 // Called when the game starts or when spawned
 void APlatformTrigger::BeginPlay()
 {
@@ -63,34 +87,144 @@ void APlatformTrigger::BeginPlay()
         PressurePadCurrentZ = PressurePadInitialZ;
     }
 
-    if (TriggerSound != nullptr)
+    if (ShouldRunOverlaps())
     {
-        // UE_LOG(LogTemp, Warning, TEXT("Sound Set"));
-        TriggerAudioComponent->SetSound(TriggerSound);
+        UPlatformSignalSubsystem::MarkGraphDirty(GetWorld());
+    }
+    else if (TriggerVolume != nullptr)
+    {
+        TriggerVolume->SetCollisionEnabled(ECollisionEnabled::NoCollision);
     }
 }
 
-void APlatformTrigger::OnOverlapBegin(UPrimitiveComponent *OverlappedComponent, AActor *OtherActor, UPrimitiveComponent *OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult &SweepResult)
+void APlatformTrigger::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+    SetPressurePadAnimating(false);
+    UPlatformSignalSubsystem::MarkGraphDirty(GetWorld());
+
+    Super::EndPlay(EndPlayReason);
+}
+
+void APlatformTrigger::GetLifetimeReplicatedProps(TArray<FLifetimeProperty> &OutLifetimeProps) const
+{
+    Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+    DOREPLIFETIME(APlatformTrigger, PressurePadActive);
+    DOREPLIFETIME(APlatformTrigger, PressedServerTime);
+}
+
+void APlatformTrigger::SetPressurePadActive(bool Active)
+{
+    PressurePadActive = Active;
+
+    // The pad is purely visual, a dedicated server never animates it
+    if (GetNetMode() == NM_DedicatedServer) return;
+    if (PressurePad == nullptr) return;
+
+    SetPressurePadAnimating(true);
+}
+
+void APlatformTrigger::SetPressurePadAnimating(bool Animating)
+{
+    if (PressurePadAnimating == Animating) return;
+
+    PressurePadAnimating = Animating;
+    NumAnimatingTriggers += Animating ? 1 : -1;
+    SetActorTickEnabled(Animating);
+}
+
+void APlatformTrigger::SetOccupied(bool Occupied)
 {
-    PressurePadActive = true;
+    SetPressurePadActive(Occupied);
+
+    if (HasAuthority())
+    {
+        if (Occupied)
+        {
+            PressedServerTime = GetServerTime();
+        }
+        FlushNetDormancy();
+    }
 
-    if (TriggerSound != nullptr)
+    if (Occupied)
     {
-        TriggerAudioComponent->Play();
+        PlayTriggerSound();
     }
 
-    for (AMovingPlatform *Platform : PlatformsToTrigger)
+    UWorld *World = GetWorld();
+    UPlatformSignalSubsystem *SignalSubsystem = World != nullptr ? World->GetSubsystem<UPlatformSignalSubsystem>() : nullptr;
+    if (SignalSubsystem != nullptr)
     {
-        Platform->AddActiveTrigger();
+        SignalSubsystem->QueueTriggerEdge(this, Occupied);
+    }
+}
+
+bool APlatformTrigger::ShouldRunOverlaps() const
+{
+    return HasAuthority() || !bServerAuthoritative;
+}
+
+void APlatformTrigger::OnRep_PressurePadActive()
+{
+    SetPressurePadActive(PressurePadActive);
+
+    // Initial replication to a late joiner also lands here, with a press from long ago
+    if (PressurePadActive && GetServerTime() - PressedServerTime <= PressSoundMaxDelay)
+    {
+        PlayTriggerSound();
+    }
+}
+
+float APlatformTrigger::GetServerTime() const
+{
+    UWorld *World = GetWorld();
+    if (World == nullptr) return 0.f;
+
+    AGameStateBase *GameState = World->GetGameState();
+    return GameState != nullptr ? GameState->GetServerWorldTimeSeconds() : World->GetTimeSeconds();
+}
+
+void APlatformTrigger::PlayTriggerSound()
+{
+    if (TriggerSound == nullptr) return;
+
+    UWorld *World = GetWorld();
+    UTriggerAudioSubsystem *AudioSubsystem = World != nullptr ? World->GetSubsystem<UTriggerAudioSubsystem>() : nullptr;
+    if (AudioSubsystem == nullptr) return;
+
+    AudioSubsystem->PlaySound(TriggerSound, GetActorLocation(), this);
+}
+
+void APlatformTrigger::OnOverlapBegin(UPrimitiveComponent *OverlappedComponent, AActor *OtherActor, UPrimitiveComponent *OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult &SweepResult)
+{
+    SCOPE_CYCLE_COUNTER(STAT_TriggerOverlap);
+
+    if (OtherActor == nullptr || OtherActor == this || !ShouldRunOverlaps()) return;
+
+    const bool WasOccupied = Occupants.Num() > 0;
+    ++Occupants.FindOrAdd(OtherActor);
+
+    if (!WasOccupied)
+    {
+        SetOccupied(true);
     }
 }
 
 void APlatformTrigger::OnOverlapEnd(UPrimitiveComponent *OverlappedComponent, AActor *OtherActor, UPrimitiveComponent *OtherComp, int32 OtherBodyIndex)
 {
-    PressurePadActive = false;
+    SCOPE_CYCLE_COUNTER(STAT_TriggerOverlap);
+
+    if (OtherActor == nullptr || OtherActor == this || !ShouldRunOverlaps()) return;
+
+    int32 *ComponentCount = Occupants.Find(OtherActor);
+    if (ComponentCount == nullptr) return;
+
+    if (--(*ComponentCount) > 0) return;
+
+    Occupants.Remove(OtherActor);
 
-    for (AMovingPlatform *Platform : PlatformsToTrigger)
+    if (Occupants.Num() == 0)
     {
-        Platform->RemoveActiveTrigger();
+        SetOccupied(false);
     }
 }
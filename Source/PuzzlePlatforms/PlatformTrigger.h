@@ -11,14 +11,23 @@ class PUZZLEPLATFORMS_API APlatformTrigger : public AActor
 {
     GENERATED_BODY()
 
+    friend class UPlatformSignalSubsystem;
+
 public:
     // Sets default values for this actor's properties
     APlatformTrigger();
     virtual void Tick(float DeltaTime) override;
+    void AddPlatformToTrigger(class AMovingPlatform *Platform);
+    bool IsOccupied() const { return Occupants.Num() > 0; }
+
+    // Number of triggers whose pressure pad is currently moving
+    static int32 GetNumAnimatingTriggers() { return NumAnimatingTriggers; }
 
 protected:
     // Called when the game starts or when spawned
     virtual void BeginPlay() override;
+    virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+    virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty> &OutLifetimeProps) const override;
 
 private:
     UPROPERTY(VisibleAnywhere)
@@ -30,16 +39,47 @@ private:
     UPROPERTY(EditAnywhere)
     TArray<class AMovingPlatform *> PlatformsToTrigger;
 
-    UPROPERTY(VisibleAnywhere)
-    class UAudioComponent *TriggerAudioComponent;
+    // Gates combining this trigger with others, see UPlatformSignalSubsystem
+    UPROPERTY(EditAnywhere)
+    TArray<class APlatformSignalGate *> GatesToSignal;
 
+    // Played through UTriggerAudioSubsystem's shared voices when the pad is pressed
     UPROPERTY(EditAnywhere)
     USoundBase *TriggerSound;
 
+    // Only the server runs overlaps and signals platforms, clients just receive the pad state
+    UPROPERTY(EditAnywhere)
+    bool bServerAuthoritative = true;
+
+    // Overlapping component count per actor standing on the trigger
+    TMap<TWeakObjectPtr<AActor>, int32> Occupants;
+
+    UPROPERTY(ReplicatedUsing = OnRep_PressurePadActive)
     bool PressurePadActive = false;
+
+    // Server time of the last press, so clients joining while the pad is down stay quiet
+    UPROPERTY(Replicated)
+    float PressedServerTime = 0.f;
+
+    bool PressurePadAnimating = false;
     float PressurePadInitialZ;
     float PressurePadCurrentZ;
 
+    static int32 NumAnimatingTriggers;
+
+    // Index into UPlatformSignalSubsystem's graph, INDEX_NONE until compiled in
+    int32 SignalNode = INDEX_NONE;
+
+    void SetPressurePadActive(bool Active);
+    void SetPressurePadAnimating(bool Animating);
+    void SetOccupied(bool Occupied);
+    void PlayTriggerSound();
+    bool ShouldRunOverlaps() const;
+    float GetServerTime() const;
+
+    UFUNCTION()
+    void OnRep_PressurePadActive();
+
     UFUNCTION()
     void OnOverlapBegin(UPrimitiveComponent *OverlappedComponent, AActor *OtherActor, UPrimitiveComponent *OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult &SweepResult);
 
@@ -8,6 +8,12 @@ public class PuzzlePlatforms : ModuleRules
 	{
 		PCHUsage = PCHUsageMode.UseExplicitOrSharedPCHs;
 
-		PublicDependencyModuleNames.AddRange(new string[] { "Core", "CoreUObject", "Engine", "InputCore", "HeadMountedDisplay", "UMG", "OnlineSubsystem", "OnlineSubsystemSteam" });
+		PublicDependencyModuleNames.AddRange(new string[] { "Core", "CoreUObject", "Engine", "InputCore", "UMG", "OnlineSubsystem", "OnlineSubsystemSteam", "ReplicationGraph", "Json" });
+
+		// Dedicated servers have no headset, camera or menus, see UE_SERVER guards in the sources
+		if (Target.Type != TargetType.Server)
+		{
+			PublicDependencyModuleNames.Add("HeadMountedDisplay");
+		}
 	}
 }
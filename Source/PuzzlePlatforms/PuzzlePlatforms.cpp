@@ -3,5 +3,18 @@
 #include "PuzzlePlatforms.h"
 #include "Modules/ModuleManager.h"
 
+DEFINE_LOG_CATEGORY(LogPuzzlePlatforms);
+
+DEFINE_STAT(STAT_PlatformUpdate);
+DEFINE_STAT(STAT_TriggerOverlap);
+DEFINE_STAT(STAT_SignalGraph);
+DEFINE_STAT(STAT_SessionCallbacks);
+DEFINE_STAT(STAT_ServerListUpdate);
+DEFINE_STAT(STAT_NumPlatforms);
+DEFINE_STAT(STAT_NumActivePlatforms);
+DEFINE_STAT(STAT_NumServerListEntries);
+DEFINE_STAT(STAT_PlatformMemory);
+DEFINE_STAT(STAT_ServerListMemory);
+
 IMPLEMENT_PRIMARY_GAME_MODULE( FDefaultGameModuleImpl, PuzzlePlatforms, "PuzzlePlatforms" );
- 
\ No newline at end of file
+ 
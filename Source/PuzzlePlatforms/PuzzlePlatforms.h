@@ -3,3 +3,30 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "Logging/LogMacros.h"
+#include "Stats/Stats.h"
+
+// Shipping builds compile out everything below Warning, so diagnostics cost nothing there
+#if UE_BUILD_SHIPPING
+#define PUZZLEPLATFORMS_LOG_COMPILE_VERBOSITY Warning
+#else
+#define PUZZLEPLATFORMS_LOG_COMPILE_VERBOSITY All
+#endif
+
+DECLARE_LOG_CATEGORY_EXTERN(LogPuzzlePlatforms, Log, PUZZLEPLATFORMS_LOG_COMPILE_VERBOSITY);
+
+// "stat PuzzlePlatforms" shows the game's own hot paths next to the engine groups
+DECLARE_STATS_GROUP(TEXT("PuzzlePlatforms"), STATGROUP_PuzzlePlatforms, STATCAT_Advanced);
+
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Platform Update"), STAT_PlatformUpdate, STATGROUP_PuzzlePlatforms, PUZZLEPLATFORMS_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Trigger Overlap"), STAT_TriggerOverlap, STATGROUP_PuzzlePlatforms, PUZZLEPLATFORMS_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Signal Graph"), STAT_SignalGraph, STATGROUP_PuzzlePlatforms, PUZZLEPLATFORMS_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Session Callbacks"), STAT_SessionCallbacks, STATGROUP_PuzzlePlatforms, PUZZLEPLATFORMS_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Server List Update"), STAT_ServerListUpdate, STATGROUP_PuzzlePlatforms, PUZZLEPLATFORMS_API);
+
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Platforms"), STAT_NumPlatforms, STATGROUP_PuzzlePlatforms, PUZZLEPLATFORMS_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Moving Platforms"), STAT_NumActivePlatforms, STATGROUP_PuzzlePlatforms, PUZZLEPLATFORMS_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Server List Entries"), STAT_NumServerListEntries, STATGROUP_PuzzlePlatforms, PUZZLEPLATFORMS_API);
+
+DECLARE_MEMORY_STAT_EXTERN(TEXT("Platform Simulation Memory"), STAT_PlatformMemory, STATGROUP_PuzzlePlatforms, PUZZLEPLATFORMS_API);
+DECLARE_MEMORY_STAT_EXTERN(TEXT("Server List Memory"), STAT_ServerListMemory, STATGROUP_PuzzlePlatforms, PUZZLEPLATFORMS_API);
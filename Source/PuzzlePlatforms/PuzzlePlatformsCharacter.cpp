@@ -1,18 +1,22 @@
 // Copyright Epic Games, Inc. All Rights Reserved.
 
 #include "PuzzlePlatformsCharacter.h"
-#include "HeadMountedDisplayFunctionLibrary.h"
 #include "Camera/CameraComponent.h"
 #include "Components/CapsuleComponent.h"
 #include "Components/InputComponent.h"
 #include "GameFramework/CharacterMovementComponent.h"
 #include "GameFramework/Controller.h"
 #include "GameFramework/SpringArmComponent.h"
+#include "PuzzlePlatformsMovementComponent.h"
+#if !UE_SERVER
+#include "HeadMountedDisplayFunctionLibrary.h"
+#endif
 
 //////////////////////////////////////////////////////////////////////////
 // APuzzlePlatformsCharacter
 
-APuzzlePlatformsCharacter::APuzzlePlatformsCharacter()
+APuzzlePlatformsCharacter::APuzzlePlatformsCharacter(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer.SetDefaultSubobjectClass<UPuzzlePlatformsMovementComponent>(ACharacter::CharacterMovementComponentName))
 {
 	// Set size for collision capsule
 	GetCapsuleComponent()->InitCapsuleSize(42.f, 96.0f);
@@ -32,6 +36,7 @@ APuzzlePlatformsCharacter::APuzzlePlatformsCharacter()
 	GetCharacterMovement()->JumpZVelocity = 600.f;
 	GetCharacterMovement()->AirControl = 0.2f;
 
+#if !UE_SERVER
 	// Create a camera boom (pulls in towards the player if there is a collision)
 	CameraBoom = CreateDefaultSubobject<USpringArmComponent>(TEXT("CameraBoom"));
 	CameraBoom->SetupAttachment(RootComponent);
@@ -42,6 +47,7 @@ APuzzlePlatformsCharacter::APuzzlePlatformsCharacter()
 	FollowCamera = CreateDefaultSubobject<UCameraComponent>(TEXT("FollowCamera"));
 	FollowCamera->SetupAttachment(CameraBoom, USpringArmComponent::SocketName); // Attach the camera to the end of the boom and let the boom adjust to match the controller orientation
 	FollowCamera->bUsePawnControlRotation = false; // Camera does not rotate relative to arm
+#endif
 
 	// Note: The skeletal mesh and anim blueprint references on the Mesh component (inherited from Character) 
 	// are set in the derived blueprint asset named MyCharacter (to avoid direct content references in C++)
@@ -79,7 +85,9 @@ void APuzzlePlatformsCharacter::SetupPlayerInputComponent(class UInputComponent*
 
 void APuzzlePlatformsCharacter::OnResetVR()
 {
+#if !UE_SERVER
 	UHeadMountedDisplayFunctionLibrary::ResetOrientationAndPosition();
+#endif
 }
 
 void APuzzlePlatformsCharacter::TouchStarted(ETouchIndex::Type FingerIndex, FVector Location)
@@ -104,17 +112,25 @@ void APuzzlePlatformsCharacter::LookUpAtRate(float Rate)
 	AddControllerPitchInput(Rate * BaseLookUpRate * GetWorld()->GetDeltaSeconds());
 }
 
+void APuzzlePlatformsCharacter::UpdateMovementBasis()
+{
+	// Control rotation only changes after input has been processed, so both axes share one basis
+	if (MovementBasisFrame == GFrameCounter) return;
+	MovementBasisFrame = GFrameCounter;
+
+	const FRotator YawRotation(0, Controller->GetControlRotation().Yaw, 0);
+	const FRotationMatrix YawMatrix(YawRotation);
+	MovementForward = YawMatrix.GetUnitAxis(EAxis::X);
+	MovementRight = YawMatrix.GetUnitAxis(EAxis::Y);
+}
+
 void APuzzlePlatformsCharacter::MoveForward(float Value)
 {
 	if ((Controller != NULL) && (Value != 0.0f))
 	{
 		// find out which way is forward
-		const FRotator Rotation = Controller->GetControlRotation();
-		const FRotator YawRotation(0, Rotation.Yaw, 0);
-
-		// get forward vector
-		const FVector Direction = FRotationMatrix(YawRotation).GetUnitAxis(EAxis::X);
-		AddMovementInput(Direction, Value);
+		UpdateMovementBasis();
+		AddMovementInput(MovementForward, Value);
 	}
 }
 
@@ -123,12 +139,8 @@ void APuzzlePlatformsCharacter::MoveRight(float Value)
 	if ( (Controller != NULL) && (Value != 0.0f) )
 	{
 		// find out which way is right
-		const FRotator Rotation = Controller->GetControlRotation();
-		const FRotator YawRotation(0, Rotation.Yaw, 0);
-	
-		// get right vector 
-		const FVector Direction = FRotationMatrix(YawRotation).GetUnitAxis(EAxis::Y);
+		UpdateMovementBasis();
 		// add movement in that direction
-		AddMovementInput(Direction, Value);
+		AddMovementInput(MovementRight, Value);
 	}
 }
@@ -11,15 +11,15 @@ class APuzzlePlatformsCharacter : public ACharacter
 {
 	GENERATED_BODY()
 
-	/** Camera boom positioning the camera behind the character */
+	/** Camera boom positioning the camera behind the character, not created on dedicated server builds */
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Camera, meta = (AllowPrivateAccess = "true"))
 	class USpringArmComponent* CameraBoom;
 
-	/** Follow camera */
+	/** Follow camera, not created on dedicated server builds */
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Camera, meta = (AllowPrivateAccess = "true"))
 	class UCameraComponent* FollowCamera;
 public:
-	APuzzlePlatformsCharacter();
+	APuzzlePlatformsCharacter(const FObjectInitializer& ObjectInitializer);
 
 	/** Base turn rate, in deg/sec. Other scaling may affect final turn rate. */
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category=Camera)
@@ -52,6 +52,9 @@ protected:
 	 */
 	void LookUpAtRate(float Rate);
 
+	/** Caches the yaw only forward and right vectors once per frame for the movement axes */
+	void UpdateMovementBasis();
+
 	/** Handler for when a touch input begins. */
 	void TouchStarted(ETouchIndex::Type FingerIndex, FVector Location);
 
@@ -63,6 +66,11 @@ protected:
 	virtual void SetupPlayerInputComponent(class UInputComponent* PlayerInputComponent) override;
 	// End of APawn interface
 
+private:
+	FVector MovementForward = FVector::ForwardVector;
+	FVector MovementRight = FVector::RightVector;
+	uint64 MovementBasisFrame = MAX_uint64;
+
 public:
 	/** Returns CameraBoom subobject **/
 	FORCEINLINE class USpringArmComponent* GetCameraBoom() const { return CameraBoom; }
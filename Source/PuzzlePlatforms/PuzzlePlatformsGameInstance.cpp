@@ -1,18 +1,29 @@
 // Fill out your copyright notice in the Description page of Project Settings.
 
 #include "PuzzlePlatformsGameInstance.h"
+#include "PuzzlePlatforms.h"
 #include "Engine/Engine.h"
+#include "GameFramework/Pawn.h"
+#include "GameFramework/PlayerController.h"
+#include "TimerManager.h"
 #include "UObject/ConstructorHelpers.h"
 #include "Blueprint/UserWidget.h"
 #include "OnlineSessionSettings.h"
+#include "Misc/CommandLine.h"
+#include "Misc/Parse.h"
 
 #include "PlatformTrigger.h"
+#include "MovingPlatformSubsystem.h"
+#include "PuzzlePlatformsMovementComponent.h"
+#include "StatsOverlay.h"
+#include "SessionEventLog.h"
 #include "MenuSystem/MainMenu.h"
 #include "MenuSystem/InGameMenu.h"
 
 
 UPuzzlePlatformsGameInstance::UPuzzlePlatformsGameInstance(const FObjectInitializer &ObjectInitializer)
 {
+#if !UE_SERVER
     ConstructorHelpers::FClassFinder<UUserWidget> MainMenuBPClass(TEXT("/Game/MenuSystem/WBP_MainMenu"));
     if (!ensure(MainMenuBPClass.Class != nullptr)) return;
     MenuClass = MainMenuBPClass.Class;
@@ -20,6 +31,7 @@ UPuzzlePlatformsGameInstance::UPuzzlePlatformsGameInstance(const FObjectInitiali
     ConstructorHelpers::FClassFinder<UUserWidget> InGameMenuBPClass(TEXT("/Game/MenuSystem/WBP_InGameMenu"));
     if (!ensure(InGameMenuBPClass.Class != nullptr)) return;
     InGameMenuClass = InGameMenuBPClass.Class;
+#endif
 }
 
 void UPuzzlePlatformsGameInstance::Init()
@@ -28,11 +40,11 @@ void UPuzzlePlatformsGameInstance::Init()
 
     if (Subsystem != nullptr)
     {
-        UE_LOG(LogTemp, Warning, TEXT("Found subsystem %s"), *Subsystem->GetSubsystemName().ToString());
+        UE_LOG(LogPuzzlePlatforms, Log, TEXT("Found subsystem %s"), *Subsystem->GetSubsystemName().ToString());
         SessionInterface = Subsystem->GetSessionInterface();
         if (SessionInterface.IsValid())
         {
-            UE_LOG(LogTemp, Warning, TEXT("Found session interface"));
+            UE_LOG(LogPuzzlePlatforms, Verbose, TEXT("Found session interface"));
             SessionInterface->OnCreateSessionCompleteDelegates.AddUObject(this, &UPuzzlePlatformsGameInstance::OnCreateSessionComplete);
             SessionInterface->OnStartSessionCompleteDelegates.AddUObject(this, &UPuzzlePlatformsGameInstance::OnStartSessionComplete);
             SessionInterface->OnEndSessionCompleteDelegates.AddUObject(this, &UPuzzlePlatformsGameInstance::OnEndSessionComplete);
@@ -43,35 +55,130 @@ void UPuzzlePlatformsGameInstance::Init()
     }
     else
     {
-        UE_LOG(LogTemp, Warning, TEXT("Found no subsystem"));
+        UE_LOG(LogPuzzlePlatforms, Warning, TEXT("Found no subsystem"));
+    }
+
+    PostLoadMapHandle = FCoreUObjectDelegates::PostLoadMapWithWorld.AddUObject(this, &UPuzzlePlatformsGameInstance::OnPostLoadMapWithWorld);
+
+    UEngine *Engine = GetEngine();
+    if (Engine != nullptr)
+    {
+        NetworkFailureHandle = Engine->OnNetworkFailure().AddUObject(this, &UPuzzlePlatformsGameInstance::OnNetworkFailure);
+        TravelFailureHandle = Engine->OnTravelFailure().AddUObject(this, &UPuzzlePlatformsGameInstance::OnTravelFailure);
+    }
+
+    // A dedicated server boots straight into ServerDefaultMap and advertises itself
+    if (IsDedicatedServerInstance())
+    {
+        HostServerName = TEXT("Dedicated Server");
+        FParse::Value(FCommandLine::Get(), TEXT("ServerName="), HostServerName);
+        SessionName = FName(*HostServerName);
+
+        SessionTrace.Begin(TEXT("dedicated"), HostServerName);
+        QueueSessionOperation(ESessionOperationType::Create, SessionName);
     }
 }
 
-void UPuzzlePlatformsGameInstance::StartSession() 
+void UPuzzlePlatformsGameInstance::Shutdown()
 {
-    if (SessionInterface.IsValid())
+    GetTimerManager().ClearTimer(ServerListRefreshTimer);
+    FCoreUObjectDelegates::PostLoadMapWithWorld.Remove(PostLoadMapHandle);
+
+    UEngine *Engine = GetEngine();
+    if (Engine != nullptr)
     {
-        SessionInterface->StartSession(FName(*HostServerName));
+        Engine->OnNetworkFailure().Remove(NetworkFailureHandle);
+        Engine->OnTravelFailure().Remove(TravelFailureHandle);
+    }
+
+    Super::Shutdown();
+}
+
+void UPuzzlePlatformsGameInstance::StartSession()
+{
+    QueueSessionOperation(ESessionOperationType::Start, SessionName);
+}
+
+void UPuzzlePlatformsGameInstance::HoldPreloadedPackage(UPackage *Package)
+{
+    if (Package != nullptr)
+    {
+        PreloadedPackages.AddUnique(Package);
+    }
+}
+
+void UPuzzlePlatformsGameInstance::BeginTravelTrace(const FString &Destination)
+{
+    TravelTrace.Begin(TEXT("travel"), Destination);
+}
+
+void UPuzzlePlatformsGameInstance::EndTravelTrace()
+{
+    TravelTrace.End(TEXT("handover"));
+    PreloadedPackages.Empty();
+}
+
+void UPuzzlePlatformsGameInstance::NotifyClientJoined()
+{
+    if (SessionTrace.IsActive() && SessionTrace.GetFlow() != TEXT("join"))
+    {
+        SessionTrace.End(TEXT("first_client"));
+    }
+}
+
+void UPuzzlePlatformsGameInstance::OnPostLoadMapWithWorld(UWorld *World)
+{
+    if (World == nullptr) return;
+
+    TravelTrace.Mark(*FString::Printf(TEXT("load_%s"), *World->GetMapName()));
+
+    if (!SessionTrace.IsActive()) return;
+
+    const ENetMode NetMode = World->GetNetMode();
+    if (NetMode == NM_Client)
+    {
+        SessionTrace.End(TEXT("connected"));
+    }
+    else if (NetMode == NM_ListenServer || NetMode == NM_DedicatedServer)
+    {
+        SessionTrace.Mark(TEXT("listening"));
     }
 }
 
 void UPuzzlePlatformsGameInstance::LoadMenu()
 {
+    if (IsDedicatedServerInstance()) return;
     if (!ensure(MenuClass != nullptr)) return;
 
-    Menu = CreateWidget<UMainMenu>(this, MenuClass);
-    if (!ensure(Menu != nullptr)) return;
+    if (Menu == nullptr)
+    {
+        Menu = CreateWidget<UMainMenu>(this, MenuClass);
+        if (!ensure(Menu != nullptr)) return;
+    }
+    else
+    {
+        Menu->ResetMenu();
+    }
 
     Menu->Setup();
     Menu->SetMenuInterface(this);
+
+    // The menu may have missed searches while it was hidden, give it everything they found
+    TArray<FServerData> Servers;
+    KnownServers.GenerateValueArray(Servers);
+    Menu->SetServerList(MoveTemp(Servers));
 }
 
 void UPuzzlePlatformsGameInstance::InGameLoadMenu()
 {
+    if (IsDedicatedServerInstance()) return;
     if (!ensure(InGameMenuClass != nullptr)) return;
 
-    InGameMenu = CreateWidget<UInGameMenu>(this, InGameMenuClass);
-    if (!ensure(InGameMenu != nullptr)) return;
+    if (InGameMenu == nullptr)
+    {
+        InGameMenu = CreateWidget<UInGameMenu>(this, InGameMenuClass);
+        if (!ensure(InGameMenu != nullptr)) return;
+    }
 
     InGameMenu->Setup();
     InGameMenu->SetMenuInterface(this);
@@ -79,46 +186,81 @@ void UPuzzlePlatformsGameInstance::InGameLoadMenu()
 
 void UPuzzlePlatformsGameInstance::Host(FString ServerName)
 {
-    HostServerName = ServerName;
+    if (!SessionInterface.IsValid()) return;
+
+    SessionTrace.Begin(TEXT("host"), ServerName);
 
-    if (SessionInterface.IsValid())
+    // Re-hosting tears the current session down first, the create is queued behind it
+    if (SessionState != ESessionState::NoSession)
     {
-        FNamedOnlineSession *ExistingSession = SessionInterface->GetNamedSession(FName(*HostServerName));
+        QueueSessionOperation(ESessionOperationType::Destroy, SessionName);
+    }
 
-        if (ExistingSession != nullptr)
-        {
-            SessionInterface->DestroySession(FName(*HostServerName));
-        }
-        else
-        {
-            CreateSession();
-        }
+    HostServerName = ServerName;
+    SessionName = FName(*HostServerName);
+
+    if (SessionInterface->GetNamedSession(SessionName) != nullptr)
+    {
+        QueueSessionOperation(ESessionOperationType::Destroy, SessionName);
     }
+
+    QueueSessionOperation(ESessionOperationType::Create, SessionName);
 }
 
-void UPuzzlePlatformsGameInstance::Join(uint32 Index, FString ServerName)
+void UPuzzlePlatformsGameInstance::Join(FString SessionId, FString ServerName)
 {
     if (!SessionInterface.IsValid()) return;
-    if (!SessionSearch.IsValid()) return;
 
-    if (Menu != nullptr)
+    const FOnlineSessionSearchResult *SearchResult = KnownSessions.Find(SessionId);
+    if (SearchResult == nullptr) return;
+
+    TearDownMenu();
+
+    SessionTrace.Begin(TEXT("join"), ServerName);
+
+    if (SessionState != ESessionState::NoSession)
     {
-        Menu->TearDown();
+        QueueSessionOperation(ESessionOperationType::Destroy, SessionName);
     }
 
     HostServerName = ServerName;
+    SessionName = FName(*HostServerName);
+    PendingJoinResult = *SearchResult;
+
+    QueueSessionOperation(ESessionOperationType::Join, SessionName);
+}
+
+void UPuzzlePlatformsGameInstance::QuickJoin()
+{
+    const FServerData *BestServer = nullptr;
+    for (const TPair<FString, FServerData> &Pair : KnownServers)
+    {
+        const FServerData &Server = Pair.Value;
+        if (Server.CurrentPlayers >= Server.MaxPlayers) continue;
 
-    SessionInterface->JoinSession(0, FName(*ServerName), SessionSearch->SearchResults[Index]);
+        if (BestServer == nullptr || Server.PingInMs < BestServer->PingInMs)
+        {
+            BestServer = &Server;
+        }
+    }
+
+    if (BestServer == nullptr)
+    {
+        UE_LOG(LogPuzzlePlatforms, Log, TEXT("No session to quick join"));
+        return;
+    }
+
+    Join(BestServer->SessionId, BestServer->Name);
 }
 
 void UPuzzlePlatformsGameInstance::End() 
 {
-    SessionInterface->EndSession(FName(*HostServerName));
+    QueueSessionOperation(ESessionOperationType::End, SessionName);
 }
 
 void UPuzzlePlatformsGameInstance::Destroy()
 {
-    SessionInterface->DestroySession(FName(*HostServerName));
+    QueueSessionOperation(ESessionOperationType::Destroy, SessionName);
 }
 
 void UPuzzlePlatformsGameInstance::LoadMainMenu()
@@ -130,153 +272,454 @@ void UPuzzlePlatformsGameInstance::LoadMainMenu()
     PlayerController->ClientTravel("/Game/MenuSystem/MainMenu", ETravelType::TRAVEL_Absolute);
 }
 
+// Cached search results are served without a new query for this long, then refreshed in the background
+static const float ServerListCacheTTL = 15.f;
+
 void UPuzzlePlatformsGameInstance::RefreshServerList() 
 {
+    if (!GetTimerManager().IsTimerActive(ServerListRefreshTimer))
+    {
+        GetTimerManager().SetTimer(ServerListRefreshTimer, this, &UPuzzlePlatformsGameInstance::BackgroundRefreshServerList, ServerListCacheTTL, true);
+    }
+
+    // The menu already shows the cached servers, only query when they are stale
+    if (IsSearchInProgress()) return;
+    if (LastSearchTime > 0 && FPlatformTime::Seconds() - LastSearchTime < ServerListCacheTTL) return;
+
+    FindServers();
+}
+
+void UPuzzlePlatformsGameInstance::PlatformNetStats()
+{
+    UWorld *World = GetWorld();
+    if (!ensure(World != nullptr)) return;
+
+    UMovingPlatformSubsystem *PlatformSubsystem = World->GetSubsystem<UMovingPlatformSubsystem>();
+    if (!ensure(PlatformSubsystem != nullptr)) return;
+
+    const int32 NumDormant = PlatformSubsystem->GetNumDormantPlatforms();
+    UE_LOG(LogPuzzlePlatforms, Display, TEXT("Platforms: %d, moving: %d, awake: %d, dormant: %d"),
+        PlatformSubsystem->GetNumPlatforms(), PlatformSubsystem->GetNumActivePlatforms(), PlatformSubsystem->GetNumPlatforms() - NumDormant, NumDormant);
+}
+
+void UPuzzlePlatformsGameInstance::MovementNetStats()
+{
+    APlayerController *PlayerController = GetFirstLocalPlayerController();
+    if (!ensure(PlayerController != nullptr)) return;
+
+    APawn *Pawn = PlayerController->GetPawn();
+    UPuzzlePlatformsMovementComponent *MovementComponent = Pawn != nullptr ? Pawn->FindComponentByClass<UPuzzlePlatformsMovementComponent>() : nullptr;
+    if (MovementComponent == nullptr) return;
+
+    UE_LOG(LogPuzzlePlatforms, Display, TEXT("Moves sent: %d, combined: %d, corrections received: %d"),
+        MovementComponent->GetNumMovesSent(), MovementComponent->GetNumMovesCombined(), MovementComponent->GetNumCorrectionsReceived());
+}
+
+void UPuzzlePlatformsGameInstance::StatsOverlay()
+{
+    if (IsDedicatedServerInstance()) return;
+
+    if (StatsOverlayWidget == nullptr)
+    {
+        StatsOverlayWidget = CreateWidget<UStatsOverlay>(this, UStatsOverlay::StaticClass());
+        if (!ensure(StatsOverlayWidget != nullptr)) return;
+    }
+
+    if (StatsOverlayWidget->IsInViewport())
+    {
+        StatsOverlayWidget->RemoveFromViewport();
+    }
+    else
+    {
+        // Above the menus so it stays readable while they are open
+        StatsOverlayWidget->AddToViewport(100);
+    }
+}
+
+void UPuzzlePlatformsGameInstance::DumpSessionEvents()
+{
+    FSessionEventLog::Get().Dump(TEXT("requested"));
+}
+
+void UPuzzlePlatformsGameInstance::OnNetworkFailure(UWorld *World, UNetDriver *NetDriver, ENetworkFailure::Type FailureType, const FString &ErrorString)
+{
+    UE_LOG(LogPuzzlePlatforms, Warning, TEXT("Network failure %s: %s"), ENetworkFailure::ToString(FailureType), *ErrorString);
+    FSessionEventLog::Get().Record(ESessionEvent::NetworkFailure, SessionName, (int32)FailureType);
+    FSessionEventLog::Get().Dump(TEXT("network failure"));
+}
+
+void UPuzzlePlatformsGameInstance::OnTravelFailure(UWorld *World, ETravelFailure::Type FailureType, const FString &ErrorString)
+{
+    UE_LOG(LogPuzzlePlatforms, Warning, TEXT("Travel failure %s: %s"), ETravelFailure::ToString(FailureType), *ErrorString);
+    FSessionEventLog::Get().Record(ESessionEvent::TravelFailure, SessionName, (int32)FailureType);
+    FSessionEventLog::Get().Dump(TEXT("travel failure"));
+}
+
+void UPuzzlePlatformsGameInstance::BackgroundRefreshServerList() 
+{
+    if (Menu == nullptr || !Menu->IsInViewport())
+    {
+        GetTimerManager().ClearTimer(ServerListRefreshTimer);
+        return;
+    }
+
+    if (IsSearchInProgress()) return;
+
+    FindServers();
+}
+
+void UPuzzlePlatformsGameInstance::TearDownMenu()
+{
+    // Nothing shows the list any more, stop searching for it in the background
+    GetTimerManager().ClearTimer(ServerListRefreshTimer);
+
+    if (Menu != nullptr)
+    {
+        Menu->TearDown();
+    }
+}
+
+bool UPuzzlePlatformsGameInstance::IsSearchInProgress() const
+{
+    return SessionSearch.IsValid() && SessionSearch->SearchState == EOnlineAsyncTaskState::InProgress;
+}
+
+void UPuzzlePlatformsGameInstance::FindServers() 
+{
+    if (!SessionInterface.IsValid()) return;
+
     SessionSearch = MakeShareable(new FOnlineSessionSearch());
 
     if (SessionSearch.IsValid())
     {
         SessionSearch->QuerySettings.Set(SEARCH_PRESENCE, true, EOnlineComparisonOp::Equals);
         SessionSearch->MaxSearchResults = 1000;
+
+        ProcessedSearchResults = 0;
+        SeenSessionIds.Reset();
+
+        // Results are picked up as they arrive rather than when the whole query finishes
+        GetTimerManager().SetTimer(SearchPollTimer, this, &UPuzzlePlatformsGameInstance::PollSessionSearch, 0.1f, true);
         SessionInterface->FindSessions(0, SessionSearch.ToSharedRef());
     }
 }
 
-void UPuzzlePlatformsGameInstance::CreateSession() 
+void UPuzzlePlatformsGameInstance::QueueSessionOperation(ESessionOperationType Type, FName InSessionName)
 {
-    if (SessionInterface.IsValid())
+    const FSessionOperation *LastOperation = PendingSessionOperations.Num() > 0 ? &PendingSessionOperations.Last() : nullptr;
+
+    // Collapse requests that repeat the last queued one or that the current state already satisfies
+    if (LastOperation != nullptr && LastOperation->Type == Type && LastOperation->SessionName == InSessionName) return;
+
+    if (LastOperation == nullptr && !SessionOperationInFlight)
+    {
+        if (Type == ESessionOperationType::Start && SessionState == ESessionState::InProgress) return;
+        if (Type == ESessionOperationType::End && (SessionState == ESessionState::Ended || SessionState == ESessionState::NoSession)) return;
+        if (Type == ESessionOperationType::Destroy && SessionState == ESessionState::NoSession && SessionInterface.IsValid() && SessionInterface->GetNamedSession(InSessionName) == nullptr) return;
+    }
+
+    // A destroy makes anything still waiting for that session pointless, a new join replaces an older one
+    PendingSessionOperations.RemoveAll([Type, InSessionName](const FSessionOperation &Operation)
     {
-        FOnlineSessionSettings SessionSettings;
+        if (Type == ESessionOperationType::Destroy) return Operation.SessionName == InSessionName && Operation.Type != ESessionOperationType::Destroy;
+        if (Type == ESessionOperationType::Join) return Operation.Type == ESessionOperationType::Join;
+        if (Type == ESessionOperationType::End) return Operation.SessionName == InSessionName && Operation.Type == ESessionOperationType::Start;
+        return false;
+    });
+
+    PendingSessionOperations.Add({Type, InSessionName});
+    FSessionEventLog::Get().Record(ESessionEvent::OperationQueued, InSessionName, (int32)Type);
+    ProcessSessionOperations();
+}
 
-        if (Subsystem->GetSubsystemName() == "NULL")
-        {
-            SessionSettings.bIsLANMatch = true;
-        }
-        else
+void UPuzzlePlatformsGameInstance::ProcessSessionOperations()
+{
+    // Online subsystems may complete synchronously, the outer call keeps draining the queue
+    if (ProcessingSessionOperations) return;
+    ProcessingSessionOperations = true;
+
+    while (!SessionOperationInFlight && PendingSessionOperations.Num() > 0)
+    {
+        const FSessionOperation Operation = PendingSessionOperations[0];
+        PendingSessionOperations.RemoveAt(0);
+
+        SessionOperationInFlight = true;
+        if (!ExecuteSessionOperation(Operation))
         {
-            SessionSettings.bIsLANMatch = false;
+            UE_LOG(LogPuzzlePlatforms, Warning, TEXT("Session operation %d on %s could not start"), (int32)Operation.Type, *Operation.SessionName.ToString());
+            FSessionEventLog::Get().Record(ESessionEvent::OperationNotStarted, Operation.SessionName, (int32)Operation.Type);
+            SessionOperationInFlight = false;
         }
+    }
 
-        SessionSettings.NumPublicConnections = 5;
-        SessionSettings.bShouldAdvertise = true;
-        SessionSettings.bUsesPresence = true;
-        SessionSettings.Set(TEXT("ServerName"), HostServerName, EOnlineDataAdvertisementType::ViaOnlineServiceAndPing);
+    ProcessingSessionOperations = false;
+}
 
-        SessionInterface->CreateSession(0, FName(*HostServerName), SessionSettings);
+bool UPuzzlePlatformsGameInstance::ExecuteSessionOperation(const FSessionOperation &Operation)
+{
+    if (!SessionInterface.IsValid()) return false;
+
+    switch (Operation.Type)
+    {
+    case ESessionOperationType::Create:
+        SessionState = ESessionState::Creating;
+        SessionTrace.Mark(TEXT("create_requested"));
+        return CreateSession(Operation.SessionName);
+
+    case ESessionOperationType::Start:
+        SessionState = ESessionState::Starting;
+        return SessionInterface->StartSession(Operation.SessionName);
+
+    case ESessionOperationType::End:
+        SessionState = ESessionState::Ending;
+        return SessionInterface->EndSession(Operation.SessionName);
+
+    case ESessionOperationType::Destroy:
+        SessionState = ESessionState::Destroying;
+        return SessionInterface->DestroySession(Operation.SessionName);
+
+    case ESessionOperationType::Join:
+        SessionState = ESessionState::Joining;
+        SessionTrace.Mark(TEXT("join_requested"));
+        return SessionInterface->JoinSession(0, Operation.SessionName, PendingJoinResult);
     }
+
+    return false;
 }
 
-void UPuzzlePlatformsGameInstance::OnCreateSessionComplete(FName SessionName, bool Success)
+void UPuzzlePlatformsGameInstance::CompleteSessionOperation()
 {
-    if (!Success)
+    SessionOperationInFlight = false;
+    ProcessSessionOperations();
+}
+
+bool UPuzzlePlatformsGameInstance::CreateSession(FName InSessionName) 
+{
+    FOnlineSessionSettings SessionSettings;
+
+    if (Subsystem->GetSubsystemName() == "NULL")
     {
-        UE_LOG(LogTemp, Warning, TEXT("Could not create session"));
-        return;
+        SessionSettings.bIsLANMatch = true;
     }
     else
     {
-        UE_LOG(LogTemp, Warning, TEXT("Created session: %s"), *SessionName.ToString());
+        SessionSettings.bIsLANMatch = false;
     }
-    
 
-    if (Menu != nullptr)
+    // Load tests raise the player cap from the command line
+    SessionSettings.NumPublicConnections = 5;
+    FParse::Value(FCommandLine::Get(), TEXT("MaxPlayers="), SessionSettings.NumPublicConnections);
+    SessionSettings.bShouldAdvertise = true;
+    SessionSettings.bIsDedicated = IsDedicatedServerInstance();
+    SessionSettings.bUsesPresence = !SessionSettings.bIsDedicated;
+    SessionSettings.Set(TEXT("ServerName"), HostServerName, EOnlineDataAdvertisementType::ViaOnlineServiceAndPing);
+
+    return SessionInterface->CreateSession(0, InSessionName, SessionSettings);
+}
+
+void UPuzzlePlatformsGameInstance::OnCreateSessionComplete(FName InSessionName, bool Success)
+{
+    SCOPE_CYCLE_COUNTER(STAT_SessionCallbacks);
+
+    SessionState = Success ? ESessionState::Pending : ESessionState::NoSession;
+    CompleteSessionOperation();
+    FSessionEventLog::Get().Record(ESessionEvent::CreateComplete, InSessionName, Success);
+
+    if (!Success)
     {
-        Menu->TearDown();
+        UE_LOG(LogPuzzlePlatforms, Warning, TEXT("Could not create session"));
+        SessionTrace.End(TEXT("create_failed"));
+        return;
     }
+    else
+    {
+        UE_LOG(LogPuzzlePlatforms, Log, TEXT("Created session: %s"), *InSessionName.ToString());
+        SessionTrace.Mark(TEXT("created"));
+    }
+
+    if (IsDedicatedServerInstance()) return;
+
+    TearDownMenu();
 
     UEngine *Engine = GetEngine();
     if (!ensure(Engine != nullptr)) return;
 
-    Engine->AddOnScreenDebugMessage(0, 5, FColor::Green, FString::Printf(TEXT("Hosting %s"), *SessionName.ToString()));
+#if !UE_BUILD_SHIPPING
+    Engine->AddOnScreenDebugMessage(0, 5, FColor::Green, FString::Printf(TEXT("Hosting %s"), *InSessionName.ToString()));
+#endif
 
     UWorld *World = GetWorld();
     if (!ensure(World != nullptr)) return;
 
+    SessionTrace.Mark(TEXT("travel"));
     World->ServerTravel("/Game/PuzzlePlatforms/Maps/Lobby?listen");
 }
 
-void UPuzzlePlatformsGameInstance::OnStartSessionComplete(FName SessionName, bool Success) 
+void UPuzzlePlatformsGameInstance::OnStartSessionComplete(FName InSessionName, bool Success) 
 {
+    SCOPE_CYCLE_COUNTER(STAT_SessionCallbacks);
+
+    SessionState = Success ? ESessionState::InProgress : ESessionState::Pending;
+    CompleteSessionOperation();
+    FSessionEventLog::Get().Record(ESessionEvent::StartComplete, InSessionName, Success);
+
     if (Success)
     {
-        UE_LOG(LogTemp, Warning, TEXT("Started session: %s"), *SessionName.ToString());
+        UE_LOG(LogPuzzlePlatforms, Log, TEXT("Started session: %s"), *InSessionName.ToString());
     }
 }
 
-void UPuzzlePlatformsGameInstance::OnEndSessionComplete(FName SessionName, bool Success) 
+void UPuzzlePlatformsGameInstance::OnEndSessionComplete(FName InSessionName, bool Success) 
 {
+    SCOPE_CYCLE_COUNTER(STAT_SessionCallbacks);
+
+    SessionState = Success ? ESessionState::Ended : ESessionState::InProgress;
+    CompleteSessionOperation();
+    FSessionEventLog::Get().Record(ESessionEvent::EndComplete, InSessionName, Success);
+
     if (Success)
     {
-        UE_LOG(LogTemp, Warning, TEXT("Ended session: %s"), *SessionName.ToString());
+        UE_LOG(LogPuzzlePlatforms, Log, TEXT("Ended session: %s"), *InSessionName.ToString());
     }
 }
 
-void UPuzzlePlatformsGameInstance::OnDestroySessionComplete(FName SessionName, bool Success)
+void UPuzzlePlatformsGameInstance::OnDestroySessionComplete(FName InSessionName, bool Success)
 {
+    SCOPE_CYCLE_COUNTER(STAT_SessionCallbacks);
+
+    // A failed destroy means there was no such session left to destroy
+    SessionState = ESessionState::NoSession;
+    CompleteSessionOperation();
+    FSessionEventLog::Get().Record(ESessionEvent::DestroyComplete, InSessionName, Success);
+
     if (Success)
     {
-        // CreateSession();
-        UE_LOG(LogTemp, Warning, TEXT("Destroyed session: %s"), *SessionName.ToString());
+        UE_LOG(LogPuzzlePlatforms, Log, TEXT("Destroyed session: %s"), *InSessionName.ToString());
     }
 }
 
 void UPuzzlePlatformsGameInstance::OnFindSessionsComplete(bool Success) 
 {
-    if (Success && SessionSearch.IsValid() && Menu != nullptr)
+    SCOPE_CYCLE_COUNTER(STAT_SessionCallbacks);
+
+    GetTimerManager().ClearTimer(SearchPollTimer);
+    FSessionEventLog::Get().Record(ESessionEvent::FindComplete, NAME_None, SessionSearch.IsValid() ? SessionSearch->SearchResults.Num() : -1);
+
+    if (Success && SessionSearch.IsValid())
+    {
+        UE_LOG(LogPuzzlePlatforms, Log, TEXT("Finished sessions search with %d results"), SessionSearch->SearchResults.Num());
+        LastSearchTime = FPlatformTime::Seconds();
+        ProcessSearchResults(true);
+    }
+}
+
+void UPuzzlePlatformsGameInstance::PollSessionSearch() 
+{
+    SCOPE_CYCLE_COUNTER(STAT_SessionCallbacks);
+
+    if (!SessionSearch.IsValid() || SessionSearch->SearchState != EOnlineAsyncTaskState::InProgress)
+    {
+        GetTimerManager().ClearTimer(SearchPollTimer);
+        return;
+    }
+
+    ProcessSearchResults(false);
+}
+
+void UPuzzlePlatformsGameInstance::ProcessSearchResults(bool Final) 
+{
+    TArray<FOnlineSessionSearchResult> &SearchResults = SessionSearch->SearchResults;
+    if (ProcessedSearchResults > SearchResults.Num())
+    {
+        ProcessedSearchResults = 0;
+    }
+
+    TArray<FServerData> Changed;
+    for (int32 i = ProcessedSearchResults; i < SearchResults.Num(); ++i)
     {
-        UE_LOG(LogTemp, Warning, TEXT("Finished sessions search"));
+        const FOnlineSessionSearchResult &SearchResult = SearchResults[i];
+        UE_LOG(LogPuzzlePlatforms, VeryVerbose, TEXT("Found session ID: %s"), *SearchResult.GetSessionIdStr());
 
-        TArray<FServerData> Servers;
-        for (FOnlineSessionSearchResult &SearchResult : SessionSearch->SearchResults)
+        FServerData ServerData;
+        ServerData.SessionId = SearchResult.GetSessionIdStr();
+        ServerData.MaxPlayers = SearchResult.Session.SessionSettings.NumPublicConnections;
+        ServerData.CurrentPlayers = ServerData.MaxPlayers - SearchResult.Session.NumOpenPublicConnections;
+        ServerData.HostUsername = SearchResult.Session.OwningUserName;
+        ServerData.PingInMs = SearchResult.PingInMs;
+
+        if (!SearchResult.Session.SessionSettings.Get(TEXT("ServerName"), ServerData.Name))
         {
-            UE_LOG(LogTemp, Warning, TEXT("Found session ID: %s"), *SearchResult.GetSessionIdStr());
-            FServerData ServerData;
-            
-            ServerData.MaxPlayers = SearchResult.Session.SessionSettings.NumPublicConnections;
-            ServerData.CurrentPlayers = ServerData.MaxPlayers - SearchResult.Session.NumOpenPublicConnections;
-            ServerData.HostUsername = SearchResult.Session.OwningUserName;
-
-            FString ServerName;
-            if (SearchResult.Session.SessionSettings.Get(TEXT("ServerName"), ServerName))
-            {
-                UE_LOG(LogTemp, Warning, TEXT("Server name found in settings: %s"), *ServerName);
-                ServerData.Name = ServerName;
-            }
-            else
+            ServerData.Name = "Server name was not found.";
+        }
+
+        SeenSessionIds.Add(ServerData.SessionId);
+        KnownSessions.Add(ServerData.SessionId, SearchResult);
+
+        FServerData *KnownServer = KnownServers.Find(ServerData.SessionId);
+        if (KnownServer == nullptr || *KnownServer != ServerData)
+        {
+            KnownServers.Add(ServerData.SessionId, ServerData);
+            Changed.Add(MoveTemp(ServerData));
+        }
+    }
+    ProcessedSearchResults = SearchResults.Num();
+
+    // Anything the finished search did not report again has gone away
+    TArray<FString> Removed;
+    if (Final)
+    {
+        for (auto It = KnownServers.CreateIterator(); It; ++It)
+        {
+            if (!SeenSessionIds.Contains(It.Key()))
             {
-                UE_LOG(LogTemp, Warning, TEXT("Server name was not found."));
-                ServerData.Name = "Server name was not found.";
+                Removed.Add(It.Key());
+                KnownSessions.Remove(It.Key());
+                It.RemoveCurrent();
             }
-
-            Servers.Add(ServerData);
         }
+    }
 
-        Menu->SetServerList(Servers);
+    if (Menu != nullptr && (Changed.Num() > 0 || Removed.Num() > 0))
+    {
+        Menu->UpdateServerList(Changed, Removed);
     }
 }
 
-void UPuzzlePlatformsGameInstance::OnJoinSessionComplete(FName SessionName, EOnJoinSessionCompleteResult::Type Result) 
+void UPuzzlePlatformsGameInstance::OnJoinSessionComplete(FName InSessionName, EOnJoinSessionCompleteResult::Type Result) 
 {
+    SCOPE_CYCLE_COUNTER(STAT_SessionCallbacks);
+
+    const bool Success = Result == EOnJoinSessionCompleteResult::Success || Result == EOnJoinSessionCompleteResult::AlreadyInSession;
+    SessionState = Success ? ESessionState::Pending : ESessionState::NoSession;
+    CompleteSessionOperation();
+    FSessionEventLog::Get().Record(ESessionEvent::JoinComplete, InSessionName, (int32)Result);
+
     if (!SessionInterface.IsValid()) return;
 
     FString Address;
-    if (!SessionInterface->GetResolvedConnectString(SessionName, Address))
+    if (!Success || !SessionInterface->GetResolvedConnectString(InSessionName, Address))
     {
-        UE_LOG(LogTemp, Warning, TEXT("Could not get connect string"));
+        UE_LOG(LogPuzzlePlatforms, Warning, TEXT("Could not get connect string"));
+        SessionTrace.End(TEXT("join_failed"));
+        FSessionEventLog::Get().Dump(TEXT("join failed"));
         return;
     }
     else
     {
-        UE_LOG(LogTemp, Warning, TEXT("Joining %s"), *Address);
+        UE_LOG(LogPuzzlePlatforms, Log, TEXT("Joining %s"), *Address);
+        SessionTrace.Mark(TEXT("joined"));
     }
 
     UEngine *Engine = GetEngine();
     if (!ensure(Engine != nullptr)) return;
 
+#if !UE_BUILD_SHIPPING
     Engine->AddOnScreenDebugMessage(0, 5, FColor::Green, FString::Printf(TEXT("Joining %s"), *Address));
+#endif
 
     APlayerController *PlayerController = GetFirstLocalPlayerController();
     if (!ensure(PlayerController != nullptr)) return;
 
+    SessionTrace.Mark(TEXT("travel"));
     PlayerController->ClientTravel(Address, ETravelType::TRAVEL_Absolute);
 }
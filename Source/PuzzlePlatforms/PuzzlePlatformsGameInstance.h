@@ -7,8 +7,38 @@
 #include "MenuSystem/MenuInterface.h"
 #include "OnlineSubsystem.h"
 #include "Interfaces/OnlineSessionInterface.h"
+#include "OnlineSessionSettings.h"
+#include "SessionTrace.h"
 #include "PuzzlePlatformsGameInstance.generated.h"
 
+enum class ESessionState : uint8
+{
+    NoSession,
+    Creating,
+    Pending,
+    Starting,
+    InProgress,
+    Ending,
+    Ended,
+    Destroying,
+    Joining
+};
+
+enum class ESessionOperationType : uint8
+{
+    Create,
+    Start,
+    End,
+    Destroy,
+    Join
+};
+
+struct FSessionOperation
+{
+    ESessionOperationType Type;
+    FName SessionName;
+};
+
 /**
  * 
  */
@@ -20,8 +50,14 @@ class PUZZLEPLATFORMS_API UPuzzlePlatformsGameInstance : public UGameInstance, p
 public:
     UPuzzlePlatformsGameInstance(const FObjectInitializer &ObjectInitializer);
     virtual void Init() override;
+    virtual void Shutdown() override;
     void StartSession();
 
+    void HoldPreloadedPackage(class UPackage *Package);
+    void BeginTravelTrace(const FString &Destination);
+    void EndTravelTrace();
+    void NotifyClientJoined();
+
     UFUNCTION(BlueprintCallable)
     void LoadMenu();
 
@@ -32,7 +68,10 @@ public:
     void Host(FString ServerName) override;
 
     UFUNCTION(Exec)
-    void Join(uint32 Index, FString ServerName) override;
+    void Join(FString SessionId, FString ServerName) override;
+
+    UFUNCTION(Exec)
+    void QuickJoin() override;
 
     UFUNCTION(Exec)
     void End() override; 
@@ -46,21 +85,83 @@ public:
     UFUNCTION(Exec)
     void RefreshServerList() override;
 
+    UFUNCTION(Exec)
+    void PlatformNetStats();
+
+    UFUNCTION(Exec)
+    void MovementNetStats();
+
+    UFUNCTION(Exec)
+    void StatsOverlay();
+
+    UFUNCTION(Exec)
+    void DumpSessionEvents();
+
 private:
     TSubclassOf<class UUserWidget> MenuClass;
     TSubclassOf<class UUserWidget> InGameMenuClass;
+
+    // Created once and reused by LoadMenu and InGameLoadMenu, also across map travel
+    UPROPERTY()
     class UMainMenu *Menu;
+
+    UPROPERTY()
     class UInGameMenu *InGameMenu;
+
+    UPROPERTY()
+    class UStatsOverlay *StatsOverlayWidget;
+
     class IOnlineSubsystem *Subsystem;
     IOnlineSessionPtr SessionInterface;
     TSharedPtr<class FOnlineSessionSearch> SessionSearch;
     FString HostServerName;
 
-    void CreateSession();
-    void OnCreateSessionComplete(FName SessionName, bool Success);
-    void OnStartSessionComplete(FName SessionName, bool Success);
-    void OnEndSessionComplete(FName SessionName, bool Success);
-    void OnDestroySessionComplete(FName SessionName, bool Success);
+    // Session operations run one at a time in request order, see QueueSessionOperation
+    FName SessionName;
+    ESessionState SessionState = ESessionState::NoSession;
+    TArray<FSessionOperation> PendingSessionOperations;
+    FOnlineSessionSearchResult PendingJoinResult;
+    bool SessionOperationInFlight = false;
+    bool ProcessingSessionOperations = false;
+
+    FSessionTrace SessionTrace;
+    FSessionTrace TravelTrace;
+
+    // Sessions found so far keyed by session ID, diffed against every new search
+    TMap<FString, FOnlineSessionSearchResult> KnownSessions;
+    TMap<FString, FServerData> KnownServers;
+    TSet<FString> SeenSessionIds;
+    int32 ProcessedSearchResults = 0;
+    FTimerHandle SearchPollTimer;
+    FTimerHandle ServerListRefreshTimer;
+    double LastSearchTime = 0;
+
+    // Keeps preloaded maps alive through the transition map's garbage collection
+    UPROPERTY()
+    TArray<class UPackage *> PreloadedPackages;
+
+    FDelegateHandle PostLoadMapHandle;
+    FDelegateHandle NetworkFailureHandle;
+    FDelegateHandle TravelFailureHandle;
+
+    void QueueSessionOperation(ESessionOperationType Type, FName InSessionName);
+    void ProcessSessionOperations();
+    bool ExecuteSessionOperation(const FSessionOperation &Operation);
+    void CompleteSessionOperation();
+    bool CreateSession(FName InSessionName);
+    void OnCreateSessionComplete(FName InSessionName, bool Success);
+    void OnStartSessionComplete(FName InSessionName, bool Success);
+    void OnEndSessionComplete(FName InSessionName, bool Success);
+    void OnDestroySessionComplete(FName InSessionName, bool Success);
     void OnFindSessionsComplete(bool Success);
-    void OnJoinSessionComplete(FName SessionName, EOnJoinSessionCompleteResult::Type Result);
+    void PollSessionSearch();
+    void BackgroundRefreshServerList();
+    void TearDownMenu();
+    bool IsSearchInProgress() const;
+    void FindServers();
+    void ProcessSearchResults(bool Final);
+    void OnJoinSessionComplete(FName InSessionName, EOnJoinSessionCompleteResult::Type Result);
+    void OnPostLoadMapWithWorld(UWorld *World);
+    void OnNetworkFailure(UWorld *World, class UNetDriver *NetDriver, ENetworkFailure::Type FailureType, const FString &ErrorString);
+    void OnTravelFailure(UWorld *World, ETravelFailure::Type FailureType, const FString &ErrorString);
 };
@@ -2,6 +2,7 @@
 
 #include "PuzzlePlatformsGameMode.h"
 #include "PuzzlePlatformsCharacter.h"
+#include "PuzzlePlatformsGameInstance.h"
 #include "UObject/ConstructorHelpers.h"
 
 APuzzlePlatformsGameMode::APuzzlePlatformsGameMode()
@@ -13,3 +14,15 @@ APuzzlePlatformsGameMode::APuzzlePlatformsGameMode()
 		DefaultPawnClass = PlayerPawnBPClass.Class;
 	}
 }
+
+void APuzzlePlatformsGameMode::PostSeamlessTravel()
+{
+	Super::PostSeamlessTravel();
+
+	// Every travelling player has been handed over to this game mode by now
+	UPuzzlePlatformsGameInstance* GameInstance = Cast<UPuzzlePlatformsGameInstance>(GetGameInstance());
+	if (GameInstance != nullptr)
+	{
+		GameInstance->EndTravelTrace();
+	}
+}
@@ -0,0 +1,181 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "PuzzlePlatformsMovementComponent.h"
+#include "GameFramework/Character.h"
+#include "GameFramework/PlayerController.h"
+#include "GameFramework/PlayerState.h"
+
+#include "MovingPlatform.h"
+#include "PlatformField.h"
+
+FNetworkPredictionData_Client *UPuzzlePlatformsMovementComponent::GetPredictionData_Client() const
+{
+    if (ClientPredictionData == nullptr)
+    {
+        UPuzzlePlatformsMovementComponent *MutableThis = const_cast<UPuzzlePlatformsMovementComponent *>(this);
+        MutableThis->ClientPredictionData = new FNetworkPredictionData_Client_PuzzlePlatforms(*this);
+    }
+
+    return ClientPredictionData;
+}
+
+bool UPuzzlePlatformsMovementComponent::ServerCheckClientError(float ClientTimeStamp, float DeltaTime, const FVector &Accel, const FVector &ClientWorldLocation, const FVector &RelativeClientLocation, UPrimitiveComponent *ClientMovementBase, FName ClientBaseBoneName, uint8 ClientMovementMode)
+{
+    if (IsWithinPlatformTolerance(RelativeClientLocation, ClientMovementBase, ClientBaseBoneName, ClientMovementMode)) return false;
+
+    return Super::ServerCheckClientError(ClientTimeStamp, DeltaTime, Accel, ClientWorldLocation, RelativeClientLocation, ClientMovementBase, ClientBaseBoneName, ClientMovementMode);
+}
+
+bool UPuzzlePlatformsMovementComponent::ServerShouldUseAuthoritativePosition(float ClientTimeStamp, float DeltaTime, const FVector &Accel, const FVector &ClientWorldLocation, const FVector &RelativeClientLocation, UPrimitiveComponent *ClientMovementBase, FName ClientBaseBoneName, uint8 ClientMovementMode)
+{
+    // Take the client's spot on the platform so the small difference does not build up
+    if (IsWithinPlatformTolerance(RelativeClientLocation, ClientMovementBase, ClientBaseBoneName, ClientMovementMode)) return true;
+
+    return Super::ServerShouldUseAuthoritativePosition(ClientTimeStamp, DeltaTime, Accel, ClientWorldLocation, RelativeClientLocation, ClientMovementBase, ClientBaseBoneName, ClientMovementMode);
+}
+
+void UPuzzlePlatformsMovementComponent::ClientAdjustPosition_Implementation(float TimeStamp, FVector NewLoc, FVector NewVel, UPrimitiveComponent *NewBase, FName NewBaseBoneName, bool bHasBase, bool bBaseRelativePosition, uint8 ServerMovementMode)
+{
+    ++NumCorrectionsReceived;
+
+    Super::ClientAdjustPosition_Implementation(TimeStamp, NewLoc, NewVel, NewBase, NewBaseBoneName, bHasBase, bBaseRelativePosition, ServerMovementMode);
+}
+
+FVector UPuzzlePlatformsMovementComponent::QuantizeAcceleration(const FVector &InAcceleration) const
+{
+    const float MaxAccel = GetMaxAcceleration();
+    if (InAcceleration.IsNearlyZero() || MaxAccel <= 0.f || AccelerationDirections <= 0 || AccelerationMagnitudeSteps <= 0) return InAcceleration;
+
+    // Characters only accelerate on the ground plane, so yaw and magnitude are all there is to snap
+    const float DirectionStep = 2.f * PI / AccelerationDirections;
+    const float Yaw = FMath::GridSnap(FMath::Atan2(InAcceleration.Y, InAcceleration.X), DirectionStep);
+
+    const float MagnitudeStep = MaxAccel / AccelerationMagnitudeSteps;
+    const float Magnitude = FMath::Clamp(FMath::GridSnap(InAcceleration.Size2D(), MagnitudeStep), MagnitudeStep, MaxAccel);
+
+    float Sin, Cos;
+    FMath::SinCos(&Sin, &Cos, Yaw);
+    return FVector(Cos * Magnitude, Sin * Magnitude, InAcceleration.Z);
+}
+
+void UPuzzlePlatformsMovementComponent::UpdateBasedMovement(float DeltaSeconds)
+{
+    Super::UpdateBasedMovement(DeltaSeconds);
+
+    const UPrimitiveComponent *Base = GetMovementBase();
+    const APlatformField *Field = Base != nullptr ? Cast<APlatformField>(Base->GetOwner()) : nullptr;
+    const int32 Instance = Field != nullptr && CurrentFloor.IsWalkableFloor() ? CurrentFloor.HitResult.Item : INDEX_NONE;
+
+    FVector InstanceLocation;
+    if (Instance == INDEX_NONE || !Field->GetInstanceLocation(Instance, InstanceLocation))
+    {
+        BaseFieldInstance = INDEX_NONE;
+        return;
+    }
+
+    // Carry the character along by however far its instance moved since the last update
+    if (Field == BaseField.Get() && Instance == BaseFieldInstance)
+    {
+        const FVector Delta = InstanceLocation - BaseFieldInstanceLocation;
+        if (!Delta.IsNearlyZero())
+        {
+            // Like the engine's based move, don't let the sweep collide with the base being followed
+            const EMoveComponentFlags OldMoveComponentFlags = MoveComponentFlags;
+            MoveComponentFlags |= MOVECOMP_IgnoreBases;
+
+            FHitResult MoveHit;
+            SafeMoveUpdatedComponent(Delta, UpdatedComponent->GetComponentQuat(), true, MoveHit, ETeleportType::TeleportPhysics);
+
+            MoveComponentFlags = OldMoveComponentFlags;
+        }
+    }
+
+    BaseField = Field;
+    BaseFieldInstance = Instance;
+    BaseFieldInstanceLocation = InstanceLocation;
+}
+
+void UPuzzlePlatformsMovementComponent::CallServerMove(const FSavedMove_Character *NewMove, const FSavedMove_Character *OldMove)
+{
+    ++NumMovesSent;
+
+    Super::CallServerMove(NewMove, OldMove);
+}
+
+float UPuzzlePlatformsMovementComponent::GetClientNetSendDeltaTime(const APlayerController *PC, const FNetworkPredictionData_Client_Character *ClientData, const FSavedMovePtr &NewMove) const
+{
+    const float DefaultDeltaTime = Super::GetClientNetSendDeltaTime(PC, ClientData, NewMove);
+
+    const APlayerState *PlayerState = PC != nullptr ? PC->PlayerState : nullptr;
+    if (PlayerState == nullptr) return DefaultDeltaTime;
+
+    float SendRate = GoodConnectionSendRate;
+    if (PlayerState->ExactPing >= PoorConnectionPing)
+    {
+        SendRate = PoorConnectionSendRate;
+    }
+    else if (PlayerState->ExactPing >= FairConnectionPing)
+    {
+        SendRate = FairConnectionSendRate;
+    }
+
+    // The engine's own throttling still applies when it asks for a longer delay
+    return FMath::Max(DefaultDeltaTime, 1.f / FMath::Max(SendRate, 1.f));
+}
+
+bool UPuzzlePlatformsMovementComponent::IsOnPredictablePlatform(const UPrimitiveComponent *ClientMovementBase) const
+{
+    if (ClientMovementBase == nullptr || ClientMovementBase != GetMovementBase()) return false;
+
+    const AMovingPlatform *Platform = Cast<AMovingPlatform>(ClientMovementBase->GetOwner());
+    return Platform != nullptr && Platform->bDeterministicMotion;
+}
+
+bool UPuzzlePlatformsMovementComponent::IsWithinPlatformTolerance(const FVector &RelativeClientLocation, UPrimitiveComponent *ClientMovementBase, FName ClientBaseBoneName, uint8 ClientMovementMode) const
+{
+    if (!IsOnPredictablePlatform(ClientMovementBase) || ClientMovementMode != PackNetworkMovementMode()) return false;
+    if (!MovementBaseUtility::UseRelativeLocation(ClientMovementBase)) return false;
+
+    // Compare in the platform's space, so the error does not include any difference in where the platform is
+    FVector BaseLocation;
+    FQuat BaseRotation;
+    MovementBaseUtility::GetMovementBaseTransform(ClientMovementBase, ClientBaseBoneName, BaseLocation, BaseRotation);
+
+    const FVector RelativeLocation = UpdatedComponent->GetComponentLocation() - BaseLocation;
+    return FVector::DistSquared(RelativeLocation, RelativeClientLocation) <= FMath::Square(PlatformClientErrorTolerance);
+}
+
+void FSavedMove_PuzzlePlatforms::SetMoveFor(ACharacter *Character, float InDeltaTime, FVector const &NewAccel, FNetworkPredictionData_Client_Character &ClientData)
+{
+    const UPuzzlePlatformsMovementComponent *MovementComponent = Cast<UPuzzlePlatformsMovementComponent>(Character->GetCharacterMovement());
+
+    // The move is simulated with the saved acceleration, so snapping it here keeps client and server in step
+    const FVector Acceleration = MovementComponent != nullptr ? MovementComponent->QuantizeAcceleration(NewAccel) : NewAccel;
+    Super::SetMoveFor(Character, InDeltaTime, Acceleration, ClientData);
+
+    if (MovementComponent != nullptr)
+    {
+        AccelDotThresholdCombine = MovementComponent->AccelerationDotThresholdCombine;
+    }
+}
+
+void FSavedMove_PuzzlePlatforms::CombineWith(const FSavedMove_Character *OldMove, ACharacter *InCharacter, APlayerController *PC, const FVector &OldStartLocation)
+{
+    Super::CombineWith(OldMove, InCharacter, PC, OldStartLocation);
+
+    UPuzzlePlatformsMovementComponent *MovementComponent = Cast<UPuzzlePlatformsMovementComponent>(InCharacter->GetCharacterMovement());
+    if (MovementComponent != nullptr)
+    {
+        MovementComponent->NotifyMovesCombined();
+    }
+}
+
+FNetworkPredictionData_Client_PuzzlePlatforms::FNetworkPredictionData_Client_PuzzlePlatforms(const UCharacterMovementComponent &ClientMovement)
+    : Super(ClientMovement)
+{
+}
+
+FSavedMovePtr FNetworkPredictionData_Client_PuzzlePlatforms::AllocateNewMove()
+{
+    return FSavedMovePtr(new FSavedMove_PuzzlePlatforms());
+}
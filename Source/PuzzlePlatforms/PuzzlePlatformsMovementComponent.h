@@ -0,0 +1,110 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "PuzzlePlatformsMovementComponent.generated.h"
+
+/**
+ * Character movement that treats deterministic moving platforms as a predictable base.
+ * Clients simulate those platforms themselves, so while standing on one a client whose
+ * position relative to the platform is within a small bound is accepted instead of corrected.
+ *
+ * Platform field instances all share one component that never moves, so the character
+ * follows the instance it stands on itself. Their component's base-relative location says
+ * nothing about the instance, so they get the engine's usual client error checks.
+ *
+ * Autonomous clients send fewer moves to keep upstream bandwidth low on poor links: moves are
+ * sent at a rate picked from their ping and combined more eagerly. Acceleration is snapped
+ * before a move is saved only so that consecutive moves match and combine more often, it
+ * still goes out as the engine's FVector_NetQuantize10 and saves no bits per move.
+ */
+UCLASS()
+class PUZZLEPLATFORMS_API UPuzzlePlatformsMovementComponent : public UCharacterMovementComponent
+{
+    GENERATED_BODY()
+
+public:
+    // Largest error relative to a deterministic platform base accepted without a correction
+    UPROPERTY(EditAnywhere, Category = "Character Movement (Networking)")
+    float PlatformClientErrorTolerance = 2.f;
+
+    // Acceleration is snapped to this many directions and magnitude steps before a move is saved,
+    // so steady input yields identical moves that can be combined
+    UPROPERTY(EditAnywhere, Category = "Character Movement (Networking)")
+    int32 AccelerationDirections = 64;
+
+    UPROPERTY(EditAnywhere, Category = "Character Movement (Networking)")
+    int32 AccelerationMagnitudeSteps = 8;
+
+    // Moves whose acceleration directions have a larger dot product than this are combined
+    UPROPERTY(EditAnywhere, Category = "Character Movement (Networking)")
+    float AccelerationDotThresholdCombine = 0.98f;
+
+    // Moves per second sent to the server by connection quality, judged from ping in ms
+    UPROPERTY(EditAnywhere, Category = "Character Movement (Networking)")
+    float GoodConnectionSendRate = 60.f;
+
+    UPROPERTY(EditAnywhere, Category = "Character Movement (Networking)")
+    float FairConnectionSendRate = 30.f;
+
+    UPROPERTY(EditAnywhere, Category = "Character Movement (Networking)")
+    float PoorConnectionSendRate = 20.f;
+
+    UPROPERTY(EditAnywhere, Category = "Character Movement (Networking)")
+    float FairConnectionPing = 80.f;
+
+    UPROPERTY(EditAnywhere, Category = "Character Movement (Networking)")
+    float PoorConnectionPing = 160.f;
+
+    virtual class FNetworkPredictionData_Client *GetPredictionData_Client() const override;
+
+    virtual bool ServerCheckClientError(float ClientTimeStamp, float DeltaTime, const FVector &Accel, const FVector &ClientWorldLocation, const FVector &RelativeClientLocation, UPrimitiveComponent *ClientMovementBase, FName ClientBaseBoneName, uint8 ClientMovementMode) override;
+    virtual bool ServerShouldUseAuthoritativePosition(float ClientTimeStamp, float DeltaTime, const FVector &Accel, const FVector &ClientWorldLocation, const FVector &RelativeClientLocation, UPrimitiveComponent *ClientMovementBase, FName ClientBaseBoneName, uint8 ClientMovementMode) override;
+    virtual void ClientAdjustPosition_Implementation(float TimeStamp, FVector NewLoc, FVector NewVel, UPrimitiveComponent *NewBase, FName NewBaseBoneName, bool bHasBase, bool bBaseRelativePosition, uint8 ServerMovementMode) override;
+
+    FVector QuantizeAcceleration(const FVector &InAcceleration) const;
+    void NotifyMovesCombined() { ++NumMovesCombined; }
+
+    int32 GetNumMovesSent() const { return NumMovesSent; }
+    int32 GetNumMovesCombined() const { return NumMovesCombined; }
+    int32 GetNumCorrectionsReceived() const { return NumCorrectionsReceived; }
+
+protected:
+    virtual void UpdateBasedMovement(float DeltaSeconds) override;
+    virtual void CallServerMove(const class FSavedMove_Character *NewMove, const class FSavedMove_Character *OldMove) override;
+    virtual float GetClientNetSendDeltaTime(const APlayerController *PC, const class FNetworkPredictionData_Client_Character *ClientData, const FSavedMovePtr &NewMove) const override;
+
+private:
+    int32 NumMovesSent = 0;
+    int32 NumMovesCombined = 0;
+    int32 NumCorrectionsReceived = 0;
+
+    // Platform field instance under the character and where it was on the last based update
+    TWeakObjectPtr<const class APlatformField> BaseField;
+    int32 BaseFieldInstance = INDEX_NONE;
+    FVector BaseFieldInstanceLocation = FVector::ZeroVector;
+
+    bool IsOnPredictablePlatform(const UPrimitiveComponent *ClientMovementBase) const;
+    bool IsWithinPlatformTolerance(const FVector &RelativeClientLocation, UPrimitiveComponent *ClientMovementBase, FName ClientBaseBoneName, uint8 ClientMovementMode) const;
+};
+
+class FSavedMove_PuzzlePlatforms : public FSavedMove_Character
+{
+public:
+    typedef FSavedMove_Character Super;
+
+    virtual void SetMoveFor(ACharacter *Character, float InDeltaTime, FVector const &NewAccel, class FNetworkPredictionData_Client_Character &ClientData) override;
+    virtual void CombineWith(const FSavedMove_Character *OldMove, ACharacter *InCharacter, APlayerController *PC, const FVector &OldStartLocation) override;
+};
+
+class FNetworkPredictionData_Client_PuzzlePlatforms : public FNetworkPredictionData_Client_Character
+{
+public:
+    typedef FNetworkPredictionData_Client_Character Super;
+
+    FNetworkPredictionData_Client_PuzzlePlatforms(const UCharacterMovementComponent &ClientMovement);
+
+    virtual FSavedMovePtr AllocateNewMove() override;
+};
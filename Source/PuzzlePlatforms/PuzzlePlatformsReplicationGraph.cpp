@@ -0,0 +1,168 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "PuzzlePlatformsReplicationGraph.h"
+#include "Engine/LevelScriptActor.h"
+#include "GameFramework/Info.h"
+#include "GameFramework/PlayerController.h"
+#include "ReplicationGraphTypes.h"
+#include "ReplicationGraphNodes.h"
+
+#include "MovingPlatform.h"
+#include "PlatformField.h"
+#include "PlatformTrigger.h"
+#include "PuzzlePlatformsCharacter.h"
+
+void UPuzzlePlatformsReplicationGraph::InitGlobalActorClassSettings()
+{
+    Super::InitGlobalActorClassSettings();
+
+    ClassRepNodePolicies.Set(AActor::StaticClass(), EClassRepNodeMapping::Spatialize_Dynamic);
+    ClassRepNodePolicies.Set(AInfo::StaticClass(), EClassRepNodeMapping::RelevantAllConnections);
+    ClassRepNodePolicies.Set(ALevelScriptActor::StaticClass(), EClassRepNodeMapping::NotRouted);
+    ClassRepNodePolicies.Set(APlayerController::StaticClass(), EClassRepNodeMapping::NotRouted);
+    ClassRepNodePolicies.Set(APuzzlePlatformsCharacter::StaticClass(), EClassRepNodeMapping::Spatialize_Dynamic);
+    ClassRepNodePolicies.Set(AMovingPlatform::StaticClass(), EClassRepNodeMapping::Spatialize_Dormancy);
+    ClassRepNodePolicies.Set(APlatformField::StaticClass(), EClassRepNodeMapping::RelevantAllConnections);
+    ClassRepNodePolicies.Set(APlatformTrigger::StaticClass(), EClassRepNodeMapping::Spatialize_Dormancy);
+
+    // Every native and blueprint actor class needs replication info before its first actor spawns,
+    // not only replicated defaults, since any actor can call SetReplicates at runtime
+    for (TObjectIterator<UClass> It; It; ++It)
+    {
+        UClass *Class = *It;
+        if (!Class->IsChildOf(AActor::StaticClass())) continue;
+        if (Class->GetName().StartsWith(TEXT("SKEL_")) || Class->GetName().StartsWith(TEXT("REINST_"))) continue;
+
+        const EClassRepNodeMapping Policy = GetMappingPolicy(Class);
+        const bool Spatialize = Policy == EClassRepNodeMapping::Spatialize_Static || Policy == EClassRepNodeMapping::Spatialize_Dynamic || Policy == EClassRepNodeMapping::Spatialize_Dormancy;
+
+        FClassReplicationInfo Info;
+        InitClassReplicationInfo(Info, Class, Spatialize);
+        GlobalActorReplicationInfoMap.SetClassInfo(Class, Info);
+    }
+}
+
+void UPuzzlePlatformsReplicationGraph::InitGlobalGraphNodes()
+{
+    GridNode = CreateNewNode<UReplicationGraphNode_GridSpatialization2D>();
+    GridNode->CellSize = GridCellSize;
+    GridNode->SpatialBias = SpatialBias;
+    AddGlobalGraphNode(GridNode);
+
+    AlwaysRelevantNode = CreateNewNode<UReplicationGraphNode_ActorList>();
+    AddGlobalGraphNode(AlwaysRelevantNode);
+}
+
+void UPuzzlePlatformsReplicationGraph::InitConnectionGraphNodes(UNetReplicationGraphConnection *RepGraphConnection)
+{
+    Super::InitConnectionGraphNodes(RepGraphConnection);
+
+    // Keeps the connection's own controller and view target relevant regardless of the grid
+    UReplicationGraphNode_AlwaysRelevant_ForConnection *ConnectionNode = CreateNewNode<UReplicationGraphNode_AlwaysRelevant_ForConnection>();
+    AddConnectionGraphNode(ConnectionNode, RepGraphConnection);
+}
+
+void UPuzzlePlatformsReplicationGraph::RouteAddNetworkActorToNodes(const FNewReplicatedActorInfo &ActorInfo, FGlobalActorReplicationInfo &GlobalInfo)
+{
+    switch (GetMappingPolicy(ActorInfo.Class))
+    {
+    case EClassRepNodeMapping::RelevantAllConnections:
+        AlwaysRelevantNode->NotifyAddNetworkActor(ActorInfo);
+        break;
+
+    case EClassRepNodeMapping::Spatialize_Static:
+        GridNode->AddActor_Static(ActorInfo, GlobalInfo);
+        break;
+
+    case EClassRepNodeMapping::Spatialize_Dynamic:
+        GridNode->AddActor_Dynamic(ActorInfo, GlobalInfo);
+        break;
+
+    case EClassRepNodeMapping::Spatialize_Dormancy:
+        GridNode->AddActor_Dormancy(ActorInfo, GlobalInfo);
+        break;
+
+    default:
+        break;
+    }
+}
+
+void UPuzzlePlatformsReplicationGraph::RouteRemoveNetworkActorToNodes(const FNewReplicatedActorInfo &ActorInfo)
+{
+    switch (GetMappingPolicy(ActorInfo.Class))
+    {
+    case EClassRepNodeMapping::RelevantAllConnections:
+        AlwaysRelevantNode->NotifyRemoveNetworkActor(ActorInfo);
+        break;
+
+    case EClassRepNodeMapping::Spatialize_Static:
+        GridNode->RemoveActor_Static(ActorInfo);
+        break;
+
+    case EClassRepNodeMapping::Spatialize_Dynamic:
+        GridNode->RemoveActor_Dynamic(ActorInfo);
+        break;
+
+    case EClassRepNodeMapping::Spatialize_Dormancy:
+        GridNode->RemoveActor_Dormancy(ActorInfo);
+        break;
+
+    default:
+        break;
+    }
+}
+
+void UPuzzlePlatformsReplicationGraph::UpdateActorReplicationSettings(AActor *Actor)
+{
+    if (Actor == nullptr) return;
+
+    FGlobalActorReplicationInfo *Info = GlobalActorReplicationInfoMap.Find(Actor);
+    if (Info == nullptr) return;
+
+    const float NetUpdateFrequency = FMath::Max(Actor->NetUpdateFrequency, 1.f);
+    Info->Settings.ReplicationPeriodFrame = FMath::Max<uint32>((uint32)FMath::RoundToFloat(NetDriver->NetServerMaxTickRate / NetUpdateFrequency), 1);
+
+    // Lists are replicated in ascending accumulated priority, a negative bias moves the actor up
+    Info->Settings.AccumulatedNetPriorityBias = 1.f - FMath::Max(Actor->NetPriority, 0.f);
+}
+
+EClassRepNodeMapping UPuzzlePlatformsReplicationGraph::GetMappingPolicy(UClass *Class)
+{
+    const EClassRepNodeMapping *Policy = ClassRepNodePolicies.Get(Class);
+    EClassRepNodeMapping Mapping = Policy != nullptr ? *Policy : EClassRepNodeMapping::NotRouted;
+
+    // Flags on the class defaults win over the inherited policy, e.g. an always relevant blueprint actor
+    AActor *ActorCDO = Cast<AActor>(Class->GetDefaultObject());
+    if (ActorCDO != nullptr && Mapping != EClassRepNodeMapping::NotRouted)
+    {
+        if (ActorCDO->bOnlyRelevantToOwner)
+        {
+            Mapping = EClassRepNodeMapping::NotRouted;
+        }
+        else if (ActorCDO->bAlwaysRelevant)
+        {
+            Mapping = EClassRepNodeMapping::RelevantAllConnections;
+        }
+        else if (Mapping == EClassRepNodeMapping::Spatialize_Dynamic && ActorCDO->GetRootComponent() != nullptr && ActorCDO->GetRootComponent()->Mobility == EComponentMobility::Static)
+        {
+            Mapping = EClassRepNodeMapping::Spatialize_Static;
+        }
+    }
+
+    ClassRepNodePolicies.Set(Class, Mapping);
+    return Mapping;
+}
+
+void UPuzzlePlatformsReplicationGraph::InitClassReplicationInfo(FClassReplicationInfo &Info, UClass *Class, bool Spatialize) const
+{
+    AActor *ActorCDO = Cast<AActor>(Class->GetDefaultObject());
+    if (!ensure(ActorCDO != nullptr)) return;
+
+    if (Spatialize)
+    {
+        Info.SetCullDistanceSquared(ActorCDO->NetCullDistanceSquared);
+    }
+
+    const float NetUpdateFrequency = FMath::Max(ActorCDO->NetUpdateFrequency, 1.f);
+    Info.ReplicationPeriodFrame = FMath::Max<uint32>((uint32)FMath::RoundToFloat(NetDriver->NetServerMaxTickRate / NetUpdateFrequency), 1);
+}
@@ -0,0 +1,56 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ReplicationGraph.h"
+#include "PuzzlePlatformsReplicationGraph.generated.h"
+
+enum class EClassRepNodeMapping : uint8
+{
+    NotRouted,               // Handled by the connection's always relevant node, e.g. player controllers
+    RelevantAllConnections,  // Game state, player states and other infos the lobby needs everywhere
+    Spatialize_Static,       // Never moves, only added to the grid cells it overlaps once
+    Spatialize_Dynamic,      // Moves every frame, characters
+    Spatialize_Dormancy,     // Static while dormant, dynamic while awake, moving platforms
+};
+
+/**
+ * Replication graph for the game and lobby maps. Actors are bucketed into a 2D spatial grid
+ * so a connection only considers the cells around its viewer, instead of every replicated
+ * actor being considered for every connection every frame.
+ */
+UCLASS(Transient, Config = Engine)
+class PUZZLEPLATFORMS_API UPuzzlePlatformsReplicationGraph : public UReplicationGraph
+{
+    GENERATED_BODY()
+
+public:
+    virtual void InitGlobalActorClassSettings() override;
+    virtual void InitGlobalGraphNodes() override;
+    virtual void InitConnectionGraphNodes(UNetReplicationGraphConnection *RepGraphConnection) override;
+    virtual void RouteAddNetworkActorToNodes(const FNewReplicatedActorInfo &ActorInfo, FGlobalActorReplicationInfo &GlobalInfo) override;
+    virtual void RouteRemoveNetworkActorToNodes(const FNewReplicatedActorInfo &ActorInfo) override;
+
+    // Picks up NetUpdateFrequency and NetPriority changes made after the actor was added
+    void UpdateActorReplicationSettings(AActor *Actor);
+
+    UPROPERTY(Config)
+    float GridCellSize = 10000.f;
+
+    // Lower bound of the grid, actors further out end up in the edge cells
+    UPROPERTY(Config)
+    FVector2D SpatialBias = FVector2D(-150000.f, -150000.f);
+
+private:
+    UPROPERTY()
+    class UReplicationGraphNode_GridSpatialization2D *GridNode;
+
+    UPROPERTY()
+    class UReplicationGraphNode_ActorList *AlwaysRelevantNode;
+
+    TClassMap<EClassRepNodeMapping> ClassRepNodePolicies;
+
+    EClassRepNodeMapping GetMappingPolicy(UClass *Class);
+    void InitClassReplicationInfo(FClassReplicationInfo &Info, UClass *Class, bool Spatialize) const;
+};
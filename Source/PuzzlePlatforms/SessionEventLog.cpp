@@ -0,0 +1,66 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "SessionEventLog.h"
+#include "PuzzlePlatforms.h"
+#include "HAL/PlatformTime.h"
+#include "Misc/DateTime.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+FSessionEventLog &FSessionEventLog::Get()
+{
+    static FSessionEventLog EventLog;
+    return EventLog;
+}
+
+#if WITH_SESSION_EVENT_LOG
+
+static const TCHAR *GetSessionEventName(ESessionEvent Type)
+{
+    switch (Type)
+    {
+    case ESessionEvent::OperationQueued: return TEXT("operation_queued");
+    case ESessionEvent::OperationNotStarted: return TEXT("operation_not_started");
+    case ESessionEvent::CreateComplete: return TEXT("create_complete");
+    case ESessionEvent::StartComplete: return TEXT("start_complete");
+    case ESessionEvent::EndComplete: return TEXT("end_complete");
+    case ESessionEvent::DestroyComplete: return TEXT("destroy_complete");
+    case ESessionEvent::FindComplete: return TEXT("find_complete");
+    case ESessionEvent::JoinComplete: return TEXT("join_complete");
+    case ESessionEvent::TracePhase: return TEXT("trace_phase");
+    case ESessionEvent::NetworkFailure: return TEXT("network_failure");
+    case ESessionEvent::TravelFailure: return TEXT("travel_failure");
+    default: return TEXT("unknown");
+    }
+}
+
+void FSessionEventLog::Record(ESessionEvent Type, FName Name, int32 Value)
+{
+    // Capacity is a power of two, the mask wraps the write position
+    FEvent &Event = Events[NumRecorded & (Capacity - 1)];
+    Event.Time = FPlatformTime::Seconds();
+    Event.Name = Name;
+    Event.Value = Value;
+    Event.Type = Type;
+    ++NumRecorded;
+}
+
+void FSessionEventLog::Dump(const TCHAR *Reason) const
+{
+    const uint32 NumEvents = FMath::Min(NumRecorded, Capacity);
+    const double Now = FPlatformTime::Seconds();
+
+    FString Text = FString::Printf(TEXT("Session events (%s), %u of %u recorded\n"), Reason, NumEvents, NumRecorded);
+    for (uint32 i = NumRecorded - NumEvents; i < NumRecorded; ++i)
+    {
+        const FEvent &Event = Events[i & (Capacity - 1)];
+        Text += FString::Printf(TEXT("%10.3f s ago  %-22s %-24s %d\n"), Now - Event.Time, GetSessionEventName(Event.Type), *Event.Name.ToString(), Event.Value);
+    }
+
+    UE_LOG(LogPuzzlePlatforms, Display, TEXT("%s"), *Text);
+
+    const FString DumpPath = FPaths::ProjectLogDir() / FString::Printf(TEXT("SessionEvents-%s.log"), *FDateTime::Now().ToString());
+    FFileHelper::SaveStringToFile(Text, *DumpPath);
+}
+
+#endif
@@ -0,0 +1,56 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+#define WITH_SESSION_EVENT_LOG !UE_BUILD_SHIPPING
+
+enum class ESessionEvent : uint8
+{
+    OperationQueued,
+    OperationNotStarted,
+    CreateComplete,
+    StartComplete,
+    EndComplete,
+    DestroyComplete,
+    FindComplete,
+    JoinComplete,
+    TracePhase,
+    NetworkFailure,
+    TravelFailure,
+};
+
+/**
+ * Fixed size ring of the most recent session and travel events. Recording only stores
+ * a small struct, formatting happens in Dump, which runs on demand and after a failed
+ * join or travel so there is a postmortem trace. Compiled out of shipping builds.
+ */
+class PUZZLEPLATFORMS_API FSessionEventLog
+{
+public:
+    static FSessionEventLog &Get();
+
+#if WITH_SESSION_EVENT_LOG
+    void Record(ESessionEvent Type, FName Name, int32 Value = 0);
+    void Dump(const TCHAR *Reason) const;
+#else
+    void Record(ESessionEvent Type, FName Name, int32 Value = 0) {}
+    void Dump(const TCHAR *Reason) const {}
+#endif
+
+private:
+#if WITH_SESSION_EVENT_LOG
+    struct FEvent
+    {
+        double Time;
+        FName Name;
+        int32 Value;
+        ESessionEvent Type;
+    };
+
+    static const uint32 Capacity = 1024;
+    FEvent Events[Capacity];
+    uint32 NumRecorded = 0;
+#endif
+};
@@ -0,0 +1,102 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "SessionTrace.h"
+#include "PuzzlePlatforms.h"
+#include "SessionEventLog.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformTime.h"
+#include "Misc/DateTime.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+namespace
+{
+    // JSON only allows escaping quotes, backslashes and control characters, anything else is written as is
+    FString EscapeJson(const FString &Value)
+    {
+        FString Escaped;
+        Escaped.Reserve(Value.Len());
+
+        for (const TCHAR Char : Value)
+        {
+            switch (Char)
+            {
+            case TCHAR('"'): Escaped += TEXT("\\\""); break;
+            case TCHAR('\\'): Escaped += TEXT("\\\\"); break;
+            case TCHAR('\n'): Escaped += TEXT("\\n"); break;
+            case TCHAR('\r'): Escaped += TEXT("\\r"); break;
+            case TCHAR('\t'): Escaped += TEXT("\\t"); break;
+            default:
+                if (Char < 0x20)
+                {
+                    Escaped += FString::Printf(TEXT("\\u%04x"), (int32)Char);
+                }
+                else
+                {
+                    Escaped.AppendChar(Char);
+                }
+            }
+        }
+
+        return Escaped;
+    }
+}
+
+FSessionTrace::~FSessionTrace()
+{
+    // A flow still running at shutdown keeps the phases it got through
+    Flush();
+}
+
+void FSessionTrace::Begin(const FString &InFlow, const FString &InSession)
+{
+    // Starting over abandons the previous flow, its phases are still worth keeping
+    Flush();
+
+    Flow = InFlow;
+    Session = InSession;
+    StartTime = FPlatformTime::Seconds();
+    PhaseTime = StartTime;
+
+    Write(TEXT("begin"), StartTime);
+}
+
+void FSessionTrace::Mark(const TCHAR *Phase)
+{
+    if (!IsActive()) return;
+
+    const double Now = FPlatformTime::Seconds();
+    Write(Phase, Now);
+    PhaseTime = Now;
+}
+
+void FSessionTrace::End(const TCHAR *Phase)
+{
+    Mark(Phase);
+    Flush();
+
+    StartTime = 0;
+    PhaseTime = 0;
+}
+
+void FSessionTrace::Write(const TCHAR *Phase, double Now)
+{
+    const double ElapsedMs = (Now - StartTime) * 1000.0;
+    const double PhaseMs = (Now - PhaseTime) * 1000.0;
+
+    UE_LOG(LogPuzzlePlatforms, Log, TEXT("%s %s: %s after %.1f ms (phase %.1f ms)"), *Flow, *Session, Phase, ElapsedMs, PhaseMs);
+    FSessionEventLog::Get().Record(ESessionEvent::TracePhase, Phase, (int32)ElapsedMs);
+
+    PendingLines += FString::Printf(
+        TEXT("{\"flow\":\"%s\",\"session\":\"%s\",\"phase\":\"%s\",\"utc\":\"%s\",\"elapsed_ms\":%.3f,\"phase_ms\":%.3f}\n"),
+        *EscapeJson(Flow), *EscapeJson(Session), *EscapeJson(Phase), *FDateTime::UtcNow().ToIso8601(), ElapsedMs, PhaseMs);
+}
+
+void FSessionTrace::Flush()
+{
+    if (PendingLines.IsEmpty()) return;
+
+    const FString TracePath = FPaths::ProjectLogDir() / TEXT("SessionTrace.jsonl");
+    FFileHelper::SaveStringToFile(PendingLines, *TracePath, FFileHelper::EEncodingOptions::ForceUTF8WithoutBOM, &IFileManager::Get(), FILEWRITE_Append);
+    PendingLines.Reset();
+}
@@ -0,0 +1,34 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Records the wall-clock time of each phase of a host, join or travel flow and
+ * appends them as JSON lines to Saved/Logs/SessionTrace.jsonl. Lines are kept in
+ * memory while the flow runs and written in one go when it ends, so marking a
+ * phase never touches the disk in the middle of a hitch sensitive flow.
+ */
+class PUZZLEPLATFORMS_API FSessionTrace
+{
+public:
+    ~FSessionTrace();
+
+    void Begin(const FString &InFlow, const FString &InSession);
+    void Mark(const TCHAR *Phase);
+    void End(const TCHAR *Phase);
+
+    bool IsActive() const { return StartTime > 0; }
+    const FString &GetFlow() const { return Flow; }
+
+private:
+    FString Flow;
+    FString Session;
+    double StartTime = 0;
+    double PhaseTime = 0;
+    FString PendingLines;
+
+    void Write(const TCHAR *Phase, double Now);
+    void Flush();
+};
@@ -0,0 +1,82 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "StatsOverlay.h"
+#include "Blueprint/WidgetTree.h"
+#include "Components/TextBlock.h"
+#include "Engine/NetDriver.h"
+#include "Engine/World.h"
+#include "GameFramework/Pawn.h"
+#include "GameFramework/PlayerController.h"
+#include "GameFramework/PlayerState.h"
+#include "HAL/PlatformTime.h"
+#include "Misc/App.h"
+
+#include "MovingPlatformSubsystem.h"
+#include "PuzzlePlatformsMovementComponent.h"
+
+// Refreshing the text every frame would cost more than most of what it shows
+static const float StatsOverlayRefreshInterval = 0.25f;
+
+bool UStatsOverlay::Initialize()
+{
+    bool Success = Super::Initialize();
+    if (!Success) return false;
+
+    if (StatsText == nullptr && WidgetTree != nullptr && WidgetTree->RootWidget == nullptr)
+    {
+        StatsText = WidgetTree->ConstructWidget<UTextBlock>(UTextBlock::StaticClass(), TEXT("StatsText"));
+        WidgetTree->RootWidget = StatsText;
+    }
+
+    return true;
+}
+
+void UStatsOverlay::NativeTick(const FGeometry &MyGeometry, float InDeltaTime)
+{
+    Super::NativeTick(MyGeometry, InDeltaTime);
+
+    RefreshTimeLeft -= InDeltaTime;
+    if (RefreshTimeLeft > 0.f || StatsText == nullptr) return;
+
+    RefreshTimeLeft = StatsOverlayRefreshInterval;
+    StatsText->SetText(FText::FromString(BuildStatsText()));
+}
+
+FString UStatsOverlay::BuildStatsText() const
+{
+    FString Text = FString::Printf(TEXT("Frame %.1f ms, game thread %.1f ms\n"), FApp::GetDeltaTime() * 1000.0, FPlatformTime::ToMilliseconds(GGameThreadTime));
+
+    UWorld *World = GetWorld();
+    if (World == nullptr) return Text;
+
+    UMovingPlatformSubsystem *PlatformSubsystem = World->GetSubsystem<UMovingPlatformSubsystem>();
+    if (PlatformSubsystem != nullptr)
+    {
+        Text += FString::Printf(TEXT("Platforms %d / %d moving, update %.3f ms\n"),
+            PlatformSubsystem->GetNumActivePlatforms(), PlatformSubsystem->GetNumPlatforms(), PlatformSubsystem->GetLastTickMs());
+    }
+
+    UNetDriver *NetDriver = World->GetNetDriver();
+    if (NetDriver != nullptr)
+    {
+        Text += FString::Printf(TEXT("Net in %.1f KB/s, out %.1f KB/s\n"), NetDriver->InBytesPerSecond / 1024.f, NetDriver->OutBytesPerSecond / 1024.f);
+    }
+
+    APlayerController *PlayerController = GetOwningPlayer() != nullptr ? GetOwningPlayer() : World->GetFirstPlayerController();
+    if (PlayerController == nullptr) return Text;
+
+    if (PlayerController->PlayerState != nullptr && World->GetNetMode() == NM_Client)
+    {
+        Text += FString::Printf(TEXT("Ping %.0f ms\n"), PlayerController->PlayerState->ExactPing);
+    }
+
+    APawn *Pawn = PlayerController->GetPawn();
+    UPuzzlePlatformsMovementComponent *MovementComponent = Pawn != nullptr ? Pawn->FindComponentByClass<UPuzzlePlatformsMovementComponent>() : nullptr;
+    if (MovementComponent != nullptr)
+    {
+        Text += FString::Printf(TEXT("Moves sent %d, combined %d, corrections %d\n"),
+            MovementComponent->GetNumMovesSent(), MovementComponent->GetNumMovesCombined(), MovementComponent->GetNumCorrectionsReceived());
+    }
+
+    return Text;
+}
@@ -0,0 +1,30 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Blueprint/UserWidget.h"
+#include "StatsOverlay.generated.h"
+
+/**
+ * Corner readout of frame time, platform simulation, ping, bandwidth and movement
+ * counters, toggled with the StatsOverlay exec command. Builds its own text block
+ * unless a blueprint subclass binds one.
+ */
+UCLASS()
+class PUZZLEPLATFORMS_API UStatsOverlay : public UUserWidget
+{
+    GENERATED_BODY()
+
+protected:
+    virtual bool Initialize() override;
+    virtual void NativeTick(const FGeometry &MyGeometry, float InDeltaTime) override;
+
+private:
+    UPROPERTY(meta = (BindWidgetOptional))
+    class UTextBlock *StatsText;
+
+    float RefreshTimeLeft = 0.f;
+
+    FString BuildStatsText() const;
+};
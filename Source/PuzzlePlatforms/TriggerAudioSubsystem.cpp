@@ -0,0 +1,127 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "TriggerAudioSubsystem.h"
+#include "PuzzlePlatforms.h"
+#include "Components/AudioComponent.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+#include "GameFramework/WorldSettings.h"
+#include "Sound/SoundBase.h"
+
+bool UTriggerAudioSubsystem::ShouldCreateSubsystem(UObject *Outer) const
+{
+#if UE_SERVER
+    return false;
+#else
+    UWorld *World = Cast<UWorld>(Outer);
+    return World != nullptr && World->IsGameWorld() && !IsRunningDedicatedServer();
+#endif
+}
+
+void UTriggerAudioSubsystem::Deinitialize()
+{
+    for (UAudioComponent *Voice : Voices)
+    {
+        if (Voice != nullptr)
+        {
+            Voice->DestroyComponent();
+        }
+    }
+
+    Voices.Empty();
+    LastPlayTimes.Empty();
+
+    Super::Deinitialize();
+}
+
+void UTriggerAudioSubsystem::PlaySound(USoundBase *Sound, const FVector &Location, const AActor *Source)
+{
+    UWorld *World = GetWorld();
+    if (Sound == nullptr || World == nullptr) return;
+
+    const float Now = World->GetTimeSeconds();
+    if (!LastPlayTimes.Contains(Source))
+    {
+        PruneLastPlayTimes(Now);
+    }
+
+    float &LastPlayTime = LastPlayTimes.FindOrAdd(Source, -MAX_flt);
+    if (Now - LastPlayTime < RetriggerCooldown) return;
+
+    if (!IsAudible(Sound, Location)) return;
+
+    UAudioComponent *Voice = FindFreeVoice(Sound);
+    if (Voice == nullptr)
+    {
+        UE_LOG(LogPuzzlePlatforms, Verbose, TEXT("Dropped trigger sound %s, no free voice"), *Sound->GetName());
+        return;
+    }
+
+    LastPlayTime = Now;
+    Voice->SetWorldLocation(Location);
+    Voice->SetSound(Sound);
+    Voice->Play();
+}
+
+void UTriggerAudioSubsystem::PruneLastPlayTimes(float Now)
+{
+    // Sources past their cooldown or destroyed would be let through anyway, only recent ones need an entry
+    for (auto It = LastPlayTimes.CreateIterator(); It; ++It)
+    {
+        if (!It.Key().IsValid() || Now - It.Value() >= RetriggerCooldown)
+        {
+            It.RemoveCurrent();
+        }
+    }
+}
+
+bool UTriggerAudioSubsystem::IsAudible(const USoundBase *Sound, const FVector &Location) const
+{
+    APlayerController *PlayerController = GetWorld()->GetFirstPlayerController();
+    if (PlayerController == nullptr) return false;
+
+    FVector ListenerLocation, FrontDirection, RightDirection;
+    PlayerController->GetAudioListenerPosition(ListenerLocation, FrontDirection, RightDirection);
+
+    // Attenuated sounds fall silent at their own range, only unattenuated ones need the fallback
+    const float SoundMaxDistance = Sound->GetMaxDistance();
+    const float CullDistance = SoundMaxDistance >= WORLD_MAX ? MaxAudibleDistance : SoundMaxDistance;
+    return FVector::DistSquared(ListenerLocation, Location) <= FMath::Square(CullDistance);
+}
+
+UAudioComponent *UTriggerAudioSubsystem::FindFreeVoice(const USoundBase *Sound)
+{
+    UAudioComponent *FreeVoice = nullptr;
+    int32 NumPlaying = 0;
+
+    for (UAudioComponent *Voice : Voices)
+    {
+        if (Voice == nullptr) continue;
+
+        if (!Voice->IsPlaying())
+        {
+            FreeVoice = FreeVoice != nullptr ? FreeVoice : Voice;
+        }
+        else if (Voice->Sound == Sound)
+        {
+            ++NumPlaying;
+        }
+    }
+
+    if (NumPlaying >= MaxVoicesPerSound) return nullptr;
+    if (FreeVoice != nullptr || Voices.Num() >= MaxVoices) return FreeVoice;
+
+    // Owned by the world settings so the voice lives exactly as long as the world
+    UWorld *World = GetWorld();
+    AWorldSettings *WorldSettings = World->GetWorldSettings();
+    if (WorldSettings == nullptr) return nullptr;
+
+    UAudioComponent *Voice = NewObject<UAudioComponent>(WorldSettings);
+    Voice->bAutoActivate = false;
+    Voice->bAutoDestroy = false;
+    Voice->SetMobility(EComponentMobility::Movable);
+    Voice->RegisterComponentWithWorld(World);
+
+    Voices.Add(Voice);
+    return Voice;
+}
@@ -0,0 +1,51 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "TriggerAudioSubsystem.generated.h"
+
+/**
+ * Plays trigger sounds through a small pool of audio components shared by every trigger.
+ * Components are only created the first time a sound actually plays, and a play is dropped
+ * when the listener is out of range, its source played too recently or too many voices of
+ * the sound are already playing. Not created where nothing is heard, like dedicated servers.
+ */
+UCLASS(Config = Game)
+class PUZZLEPLATFORMS_API UTriggerAudioSubsystem : public UWorldSubsystem
+{
+    GENERATED_BODY()
+
+public:
+    virtual bool ShouldCreateSubsystem(UObject *Outer) const override;
+    virtual void Deinitialize() override;
+
+    void PlaySound(class USoundBase *Sound, const FVector &Location, const AActor *Source);
+
+    int32 GetNumVoices() const { return Voices.Num(); }
+
+private:
+    UPROPERTY(Config)
+    int32 MaxVoices = 8;
+
+    UPROPERTY(Config)
+    int32 MaxVoicesPerSound = 3;
+
+    // Seconds before the same source may play again
+    UPROPERTY(Config)
+    float RetriggerCooldown = 0.3f;
+
+    // Used for sounds without attenuation, which would otherwise be heard map wide
+    UPROPERTY(Config)
+    float MaxAudibleDistance = 5000.f;
+
+    UPROPERTY()
+    TArray<class UAudioComponent *> Voices;
+
+    TMap<TWeakObjectPtr<const AActor>, float> LastPlayTimes;
+
+    void PruneLastPlayTimes(float Now);
+    bool IsAudible(const class USoundBase *Sound, const FVector &Location) const;
+    class UAudioComponent *FindFreeVoice(const class USoundBase *Sound);
+};